@@ -0,0 +1,477 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+// Throughput and latency of the serializers against a plain memcpy baseline
+// Usage: Benchmark [iterations]
+// Without iterations every case processes about 256 MiB.
+
+#include <set>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerIostreamHelper.h"
+#include "SerializerChecksum.h"
+#include "SerializerCompression.h"
+#include "SerializerGather.h"
+#include "SerializerAsyncFile.h"
+#include "SerializerParallel.h"
+#include "SerializerPacked.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using serializer_helper::Layout;
+using serializer_helper::BufferedStream;
+using serializer_helper::ChecksumStream;
+using serializer_helper::CompressedStream;
+using serializer_helper::LzCodec;
+using serializer_helper::GatherWriter;
+using serializer_helper::ScatterReader;
+using serializer_helper::AsyncFileWriter;
+using serializer_helper::Parallel;
+using serializer_helper::Packed;
+
+namespace
+{
+
+	using Clock = std::chrono::steady_clock;
+
+	// Keep the compiler from dropping unused results
+	template <typename Val>
+	void keep(Val const& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r"(&value) : "memory");
+#else
+		static void const* volatile sink;
+		sink = &value;
+#endif
+	}
+
+	// Stage of a case, timed or not
+	using Step = std::function<void()>;
+
+	// One target serializing one data set
+	struct Case
+	{
+		std::string_view target;
+		Step prepare, write, rewind, read, check;
+	};
+
+	// Data set, bytes is the payload size of one iteration, ops the values in it
+	struct DataSet
+	{
+		std::string_view name;
+		size_t bytes, ops;
+	};
+
+	struct Timings
+	{
+		std::vector<double> write, read;
+	};
+
+	double percentile(std::vector<double> values, double p)
+	{
+		std::ranges::sort(values);
+		return values[std::min(values.size() - 1, size_t(p * double(values.size())))];
+	}
+
+	double total(std::vector<double> const& values)
+	{
+		double sum{};
+		for (double value : values)
+			sum += value;
+		return sum;
+	}
+
+	double elapsed(Step const& step)
+	{
+		auto const begin = Clock::now();
+		step();
+		return std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+	}
+
+	void run(DataSet const& set, Case const& c, size_t iterations)
+	{
+		Timings timings;
+
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			c.prepare();
+			timings.write.push_back(elapsed(c.write));
+			c.rewind();
+			timings.read.push_back(elapsed(c.read));
+		}
+
+		c.check();
+
+		// MiB/s over all iterations, ns per value of the median and slowest percentile iteration
+		auto const mibps = [&](std::vector<double> const& ns) { return double(set.bytes * iterations) / (1024. * 1024.) / (total(ns) * 1e-9); };
+		auto const latency = [&](std::vector<double> const& ns, double p) { return percentile(ns, p) / double(set.ops); };
+
+		std::printf("%-16s %-20s %10.1f %10.1f %10.2f %10.2f %10.2f %10.2f\n",
+			set.name.data(), c.target.data(),
+			mibps(timings.write), mibps(timings.read),
+			latency(timings.write, .5), latency(timings.write, .99),
+			latency(timings.read, .5), latency(timings.read, .99)
+		);
+	}
+
+	void expect(bool condition, std::string_view what)
+	{
+		if (!condition)
+		{
+			std::fprintf(stderr, "Round trip mismatch: %s\n", what.data());
+			std::exit(EXIT_FAILURE);
+		}
+	}
+
+	// Large enough for every data set, kept off the stack
+	constexpr size_t fixed_capacity = 32 * 1024 * 1024;
+
+	// Runs every target on a data set
+	// Copy is the memcpy baseline, writes the values into a byte vector and reads them back
+	template <typename Val, typename Copy>
+	void bench(DataSet set, std::vector<Val> const& values, Copy copy, size_t iterations)
+	{
+		if (iterations == 0)
+			iterations = std::max<size_t>(3, 256 * 1024 * 1024 / std::max<size_t>(set.bytes, 1));
+
+		std::vector<Val> out(values.size());
+		auto const check = [&] { expect(out == values, set.name); };
+
+		// Containers are read into empty ones
+		auto const fresh = [&] { std::ranges::fill(out, Val{}); };
+
+		auto const write_all = [&](auto& stream) { for (Val const& value : values) Layout<Val>::Write(stream, value); };
+		auto const read_all = [&](auto& stream) { for (Val& value : out) Layout<Val>::Read(stream, value); };
+
+		// Baseline
+		{
+			std::vector<std::byte> bytes;
+			run(set, {
+				"memcpy",
+				[&] { bytes.clear(); },
+				[&] { copy.write(values, bytes); keep(bytes); },
+				fresh,
+				[&] { copy.read(bytes, out); keep(out); },
+				check
+			}, iterations);
+		}
+
+		// Fixed size buffer
+		{
+			auto buffer = std::make_unique<Serializer<fixed_capacity>>();
+			run(set, {
+				"Serializer<N>",
+				[&] { buffer->clear(); },
+				[&] { write_all(*buffer); },
+				fresh,
+				[&] { read_all(*buffer); keep(out); },
+				check
+			}, iterations);
+		}
+
+		// Dynamic buffer, grows on the first iteration
+		{
+			Serializer buffer(SerializerGrowth{});
+			run(set, {
+				"Serializer<>",
+				[&] { buffer.clear(); },
+				[&] { write_all(buffer); },
+				fresh,
+				[&] { read_all(buffer); keep(out); },
+				check
+			}, iterations);
+		}
+
+		// In memory stream
+		{
+			std::stringstream stream;
+			run(set, {
+				"stringstream",
+				[&] { stream.str({}); stream.clear(); },
+				[&] { write_all(stream); },
+				[&] { stream.seekg(0); fresh(); },
+				[&] { read_all(stream); keep(out); },
+				check
+			}, iterations);
+		}
+
+		// Files, the write includes flushing to the page cache
+		auto const path = std::filesystem::temp_directory_path() / "ConstexprSerializerBenchmark.bin";
+		{
+			std::ofstream os;
+			std::ifstream is;
+			run(set, {
+				"ofstream/ifstream",
+				[&] { os.open(path, std::ios::binary | std::ios::trunc); },
+				[&] { write_all(os); os.close(); },
+				[&] { is.open(path, std::ios::binary); fresh(); },
+				[&] { read_all(is); is.close(); keep(out); },
+				check
+			}, iterations);
+		}
+		{
+			std::ofstream os;
+			std::ifstream is;
+			run(set, {
+				"BufferedStream",
+				[&] { os.open(path, std::ios::binary | std::ios::trunc); },
+				[&] { { BufferedStream buffered{ os }; write_all(buffered); } os.close(); },
+				[&] { is.open(path, std::ios::binary); fresh(); },
+				[&] { { BufferedStream buffered{ is }; read_all(buffered); } is.close(); keep(out); },
+				check
+			}, iterations);
+		}
+		{
+			std::ofstream os;
+			std::ifstream is;
+			run(set, {
+				"ChecksumStream",
+				[&] { os.open(path, std::ios::binary | std::ios::trunc); },
+				[&] { { ChecksumStream checked{ os }; write_all(checked); } os.close(); },
+				[&] { is.open(path, std::ios::binary); fresh(); },
+				[&] { { ChecksumStream checked{ is }; read_all(checked); } is.close(); keep(out); },
+				check
+			}, iterations);
+		}
+		{
+			std::ofstream os;
+			std::ifstream is;
+			run(set, {
+				"CompressedStream",
+				[&] { os.open(path, std::ios::binary | std::ios::trunc); },
+				[&] { { CompressedStream<LzCodec, std::ofstream> compressed{ os }; write_all(compressed); } os.close(); },
+				[&] { is.open(path, std::ios::binary); fresh(); },
+				[&] { { CompressedStream<LzCodec, std::ifstream> compressed{ is }; read_all(compressed); } is.close(); keep(out); },
+				check
+			}, iterations);
+		}
+		{
+			// Only the time the writing thread is held up, the file is closed untimed
+			std::optional<AsyncFileWriter<>> writer;
+			std::ifstream is;
+			run(set, {
+				"AsyncFileWriter",
+				[&] { writer.emplace(path); },
+				[&] { write_all(*writer); },
+				[&] { writer.reset(); is.open(path, std::ios::binary); fresh(); },
+				[&] { { BufferedStream buffered{ is }; read_all(buffered); } is.close(); keep(out); },
+				check
+			}, iterations);
+		}
+#if !defined(_WIN32)
+		{
+			// Large arrays are written from the values in place
+			int file = -1;
+			run(set, {
+				"GatherWriter",
+				[&] { file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644); },
+				[&] { { GatherWriter writer{ file }; write_all(writer); } ::close(file); },
+				[&] { file = ::open(path.c_str(), O_RDONLY); fresh(); },
+				[&] { { ScatterReader reader{ file }; read_all(reader); } ::close(file); keep(out); },
+				check
+			}, iterations);
+		}
+#endif
+		std::filesystem::remove(path);
+	}
+
+	//
+	// Baselines, write raw bytes with a length before every string
+	//
+
+	void append(std::vector<std::byte>& bytes, void const* src, size_t count)
+	{
+		size_t const offset = bytes.size();
+		bytes.resize(offset + count);
+		std::memcpy(bytes.data() + offset, src, count);
+	}
+
+	struct CopyTrivial
+	{
+		template <typename Val>
+		void write(std::vector<Val> const& values, std::vector<std::byte>& bytes) const
+		{
+			append(bytes, values.data(), values.size() * sizeof(Val));
+		}
+
+		template <typename Val>
+		void read(std::vector<std::byte> const& bytes, std::vector<Val>& values) const
+		{
+			std::memcpy(values.data(), bytes.data(), values.size() * sizeof(Val));
+		}
+	};
+
+	struct CopyVector
+	{
+		template <typename Cont>
+		void write(std::vector<Cont> const& values, std::vector<std::byte>& bytes) const
+		{
+			for (auto const& value : values)
+			{
+				size_t const size = value.size();
+				append(bytes, &size, sizeof(size));
+				append(bytes, value.data(), size * sizeof(typename Cont::value_type));
+			}
+		}
+
+		template <typename Cont>
+		void read(std::vector<std::byte> const& bytes, std::vector<Cont>& values) const
+		{
+			using Val = typename Cont::value_type;
+
+			std::byte const* src = bytes.data();
+			for (auto& value : values)
+			{
+				size_t size;
+				std::memcpy(&size, src, sizeof(size));
+				value.resize(size);
+				std::memcpy(value.data(), src + sizeof(size), size * sizeof(Val));
+				src += sizeof(size) + size * sizeof(Val);
+			}
+		}
+	};
+
+	struct CopyStrings
+	{
+		template <typename Cont>
+		void write(std::vector<Cont> const& values, std::vector<std::byte>& bytes) const
+		{
+			for (Cont const& strings : values)
+			{
+				size_t const count = strings.size();
+				append(bytes, &count, sizeof(count));
+				for (std::string const& string : strings)
+				{
+					size_t const size = string.size();
+					append(bytes, &size, sizeof(size));
+					append(bytes, string.data(), size);
+				}
+			}
+		}
+
+		template <typename Cont>
+		void read(std::vector<std::byte> const& bytes, std::vector<Cont>& values) const
+		{
+			std::byte const* src = bytes.data();
+			auto const take = [&src]
+			{
+				size_t size;
+				std::memcpy(&size, src, sizeof(size));
+				src += sizeof(size);
+				return size;
+			};
+
+			for (Cont& strings : values)
+			{
+				strings.clear();
+				for (size_t count = take(); count != 0; --count)
+				{
+					size_t const size = take();
+					strings.insert(strings.end(), std::string(reinterpret_cast<char const*>(src), size));
+					src += size;
+				}
+			}
+		}
+	};
+
+	struct Pod
+	{
+		int32_t id;
+		float x, y, z;
+		double time;
+
+		friend bool operator == (Pod const&, Pod const&) = default;
+	};
+
+	std::string random_string(std::mt19937_64& random)
+	{
+		std::string string(random() % 64, '\0');
+		for (char& c : string)
+			c = char('a' + random() % 26);
+		return string;
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	size_t const iterations = argc > 1 ? size_t(std::strtoull(argv[1], nullptr, 10)) : 0;
+
+	std::mt19937_64 random{ 2022 };
+
+	std::printf("%-16s %-20s %10s %10s %10s %10s %10s %10s\n",
+		"data", "target", "write MiB/s", "read MiB/s", "write p50", "write p99", "read p50", "read p99");
+
+	// Many small values, latency is per value
+	{
+		std::vector<Pod> pods(64 * 1024);
+		for (int32_t i = 0; Pod& pod : pods)
+			pod = { i++, float(random() % 1000), float(random() % 1000), float(random() % 1000), double(random()) };
+
+		bench({ "POD", pods.size() * sizeof(Pod), pods.size() }, pods, CopyTrivial{}, iterations);
+	}
+
+	// One large vector
+	{
+		std::vector<std::vector<uint64_t>> vectors(1, std::vector<uint64_t>(1024 * 1024));
+		for (uint64_t& value : vectors.front())
+			value = random();
+
+		bench({ "vector<uint64_t>", vectors.front().size() * sizeof(uint64_t), 1 }, vectors, CopyVector{}, iterations);
+	}
+
+	// Sorted ids, delta coded and bit packed
+	{
+		std::vector<Packed<std::vector<uint32_t>>> ids(1, Packed<std::vector<uint32_t>>(1024 * 1024));
+		for (uint32_t id = 0; uint32_t& value : ids.front())
+			value = id += uint32_t(1 + random() % 64);
+
+		bench({ "Packed<ids>", ids.front().size() * sizeof(uint32_t), 1 }, ids, CopyVector{}, iterations);
+	}
+
+	// Many short strings
+	{
+		std::vector<std::vector<std::string>> strings(1);
+		std::set<std::string> unique;
+		size_t bytes{};
+		for (size_t i = 0; i < 64 * 1024; ++i)
+		{
+			strings.front().push_back(random_string(random));
+			bytes += strings.front().back().size() + sizeof(size_t);
+			unique.insert(strings.front().back());
+		}
+
+		bench({ "vector<string>", bytes, strings.front().size() }, strings, CopyStrings{}, iterations);
+
+		// The same strings encoded and decoded in chunks on every hardware thread
+		std::vector<Parallel<std::vector<std::string>>> chunked{ strings.front() };
+		bench({ "Parallel<...>", bytes, chunked.front().size() }, chunked, CopyStrings{}, iterations);
+
+		bytes = 0;
+		for (std::string const& string : unique)
+			bytes += string.size() + sizeof(size_t);
+
+		std::vector<std::set<std::string>> sets{ std::move(unique) };
+		bench({ "set<string>", bytes, sets.front().size() }, sets, CopyStrings{}, iterations);
+	}
+}
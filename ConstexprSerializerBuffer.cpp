@@ -101,3 +101,52 @@ static_assert(
 	(),
 	"vector and struct serialization"
 );
+
+static_assert(
+	[]
+	{
+		Serializer io(4, SerializerGrowth{ .factor = 1.5 });
+		io.write(13);
+		io.write(27ll); // grows
+		io.write(std::array{ 1, 2, 3 });
+
+		bool const read = io.read<int>() == 13; // keeps the read position
+		io.reserve(128);
+		io.write(short(7));
+		io.shrink_to_fit();
+
+		return read
+			&& io.read<long long>() == 27ll
+			&& io.read<std::array<int, 3>>()[2] == 3
+			&& io.read<short>() == 7
+			&& io.capacity() == 4 + 8 + 12 + 2;
+	}
+	(),
+	"Growing dynamic buffer"
+);
+
+static_assert(
+	[]
+	{
+		// 64 KB lookup table, in bulk and value by value
+		std::array<uint32_t, 16 * 1024> table{};
+		for (uint32_t i = 0; i < table.size(); ++i)
+			table[i] = i * 2654435761u;
+
+		Serializer<2 * sizeof(table)> io{};
+		io.write(table);
+		for (uint32_t value : std::span{ table }.first(1024))
+			io.write(value);
+
+		std::array<uint32_t, 16 * 1024> replica{};
+		io.read(replica);
+
+		bool single = true;
+		for (uint32_t value : std::span{ table }.first(1024))
+			single = single && io.read<uint32_t>() == value;
+
+		return single && replica == table && io.size() == 0;
+	}
+	(),
+	"Compile time table"
+);
@@ -5,16 +5,36 @@
 
 #include <bit>
 #include <span>
+#include <cstring>
+#include <cstdint>
 #include <array>
 #include <ranges>
 #include <vector>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <memory_resource>
 #include <stdexcept>
 #include <algorithm>
 
 
-template <size_t EXTENT = std::dynamic_extent>
+// The allocator is used by the dynamic Serializer only
+template <size_t EXTENT = std::dynamic_extent, typename Allocator = std::allocator<std::byte>>
 class Serializer;
 
+// Dynamic Serializer allocating from a std::pmr::memory_resource
+using PmrSerializer = Serializer<std::dynamic_extent, std::pmr::polymorphic_allocator<std::byte>>;
+
+// Capacity policy of a growing dynamic Serializer
+struct SerializerGrowth
+{
+	// Capacity multiplier applied when a write does not fit
+	double factor{ 2. };
+
+	// Writes requiring more throw a buffer overflow
+	size_t max_capacity{ std::numeric_limits<size_t>::max() };
+};
+
 namespace detail {
 
 	// Base implementation
@@ -64,8 +84,7 @@ namespace detail {
 		// Write memory (iostream alike)
 		constexpr SerializerBase& write(char const* src, std::streamsize count)
 		{
-			if (count > std::ssize(m_Free))
-				throw std::runtime_error{ "Buffer overflow" };
+			require_free(size_t(count), "Buffer overflow");
 
 			write(std::span{ src, src + count });
 
@@ -88,23 +107,14 @@ namespace detail {
 		template <typename Val> requires std::is_trivially_copyable_v<Val>
 		constexpr SerializerBase& write(Val const& value)
 		{
-			if (sizeof(Val) > m_Free.size())
-				throw std::runtime_error{ "Buffer overflow" };
+			require_free(sizeof(Val), "Buffer overflow");
 
-			auto const bytes = std::bit_cast<Bytes<Val>>(value); // reinterpret_cast
-			
-			m_Free = { 
-				std::ranges::copy(bytes, m_Free.begin()).out,
-				m_Free.end() 
-			};
-
-			m_ToRead = {
-				// to_address because of debug iterator mismatch assert
-				std::to_address(m_ToRead.begin()),
-				std::to_address(m_Free  .begin())
-			};
-	
-			return *this;
+			if (std::is_constant_evaluated())
+				copy_bytes(std::bit_cast<Bytes<Val>>(value).data(), m_Free.data(), sizeof(Val)); // reinterpret_cast
+			else
+				std::memcpy(m_Free.data(), &value, sizeof(Val));
+
+			return commit_write(sizeof(Val));
 		}
 		//
 		// Read value
@@ -115,10 +125,12 @@ namespace detail {
 				throw std::runtime_error{ "Buffer empty" };
 	
 			Bytes<Val> bytes{};
-			m_ToRead = {
-				std::ranges::copy_n(m_ToRead.begin(), bytes.size(), bytes.begin()).in,
-				m_ToRead.end()
-			};
+			if (std::is_constant_evaluated())
+				copy_bytes(m_ToRead.data(), bytes.data(), sizeof(Val));
+			else
+				std::memcpy(bytes.data(), m_ToRead.data(), sizeof(Val));
+
+			commit_read(sizeof(Val));
 			return std::bit_cast<Val>(bytes);
 		}
 		//
@@ -132,12 +144,60 @@ namespace detail {
 		}
 
 
+		// View bytes (no copy)
+		// The view is valid until the buffer is cleared or overwritten
+		constexpr std::span<std::byte const> view(size_t count)
+		{
+			if (count > m_ToRead.size())
+				throw std::runtime_error{ "Buffer holds too little data" };
+
+			std::span<std::byte const> const bytes{ m_ToRead.first(count) };
+			commit_read(count);
+			return bytes;
+		}
+		//
+		// View values (no copy)
+		// Not constexpr, the queued bytes are reinterpreted and must be aligned for Val
+		template <typename Val> requires std::is_trivially_copyable_v<Val>
+		std::span<Val const> view(size_t count)
+		{
+			if (reinterpret_cast<std::uintptr_t>(m_ToRead.data()) % alignof(Val) != 0)
+				throw std::runtime_error{ "Queued bytes are misaligned for view" };
+
+			if (count > m_ToRead.size() / sizeof(Val))
+				throw std::runtime_error{ "Buffer holds too little data" };
+
+			return { reinterpret_cast<Val const*>(view(count * sizeof(Val)).data()), count };
+		}
+
+
 		// Write values (ranges range)
 		template <std::ranges::sized_range Source, typename Value = std::ranges::range_value_t<Source>> requires std::is_trivially_copyable_v<Value>
 		constexpr SerializerBase& write(Source&& source)
 		{
-			if (std::ranges::size(source) * sizeof(Value) > m_Free.size())
-				throw std::exception{ "Range too large, insufficient buffer size" };
+			size_t const count{ std::ranges::size(source) * sizeof(Value) };
+
+			require_free(count, "Range too large, insufficient buffer size");
+
+			// Contiguous memory can be copied at once outside of constant evaluation, and in chunks during it
+			if constexpr (std::ranges::contiguous_range<Source>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					if (count != 0)
+						std::memcpy(m_Free.data(), std::ranges::data(source), count);
+
+					return commit_write(count);
+				}
+				else if constexpr (std::default_initializable<Value>)
+				{
+					Value const* const values = std::ranges::data(source);
+					for (size_t done = 0, size = std::ranges::size(source); done < size; done += chunk_size<Value>)
+						write_chunk(values + done, std::min(size - done, chunk_size<Value>));
+
+					return *this;
+				}
+			}
 
 			for (auto& value : source)
 				write(value);
@@ -149,8 +209,30 @@ namespace detail {
 		template <std::ranges::sized_range Dst, typename Value = std::ranges::range_value_t<Dst>> requires std::is_trivially_copyable_v<Value>
 		constexpr SerializerBase& read(Dst&& dest)
 		{
-			if (std::ranges::size(dest) * sizeof(Value) > m_ToRead.size())
-				throw std::exception{ "Range too large, insufficient bytes queued" };
+			size_t const count{ std::ranges::size(dest) * sizeof(Value) };
+
+			if (count > m_ToRead.size())
+				throw std::runtime_error{ "Range too large, insufficient bytes queued" };
+
+			// Contiguous memory can be copied at once outside of constant evaluation, and in chunks during it
+			if constexpr (std::ranges::contiguous_range<Dst> && !std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<Dst>>>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					if (count != 0)
+						std::memcpy(std::ranges::data(dest), m_ToRead.data(), count);
+
+					return commit_read(count);
+				}
+				else if constexpr (std::default_initializable<Value>)
+				{
+					Value* const values = std::ranges::data(dest);
+					for (size_t done = 0, size = std::ranges::size(dest); done < size; done += chunk_size<Value>)
+						read_chunk(values + done, std::min(size - done, chunk_size<Value>));
+
+					return *this;
+				}
+			}
 
 			for (auto& value : dest)
 				read(value);
@@ -191,6 +273,38 @@ namespace detail {
 		}
 
 
+		// Amount of bytes queued for reading
+		constexpr size_t size() const noexcept
+		{
+			return m_ToRead.size();
+		}
+
+		// Bytes queued for reading (no copy), without reading them
+		constexpr std::span<std::byte const> queued() const noexcept
+		{
+			return m_ToRead;
+		}
+
+
+		// Free memory of at least count bytes (growing if enabled), throws when insufficient
+		// Bytes written into it are queued by commit
+		constexpr std::span<std::byte> prepare(size_t count)
+		{
+			require_free(count, "Buffer overflow");
+
+			return m_Free;
+		}
+		//
+		// Queue count bytes written into the prepared memory
+		constexpr SerializerBase& commit(size_t count)
+		{
+			if (count > m_Free.size())
+				throw std::runtime_error{ "Buffer overflow" };
+
+			return commit_write(count);
+		}
+
+
 		// Reset buffer
 		constexpr void reset_buffer(std::span<std::byte> buffer)
 		{
@@ -207,19 +321,119 @@ namespace detail {
 			reset_buffer(m_Buffer);
 		}
 
+
+	protected:
+
+		// Growth hook, receives the required buffer size and returns the reallocated buffer
+		using Grow = std::span<std::byte>(*)(SerializerBase&, size_t required);
+
+		// Enable growing the buffer when a write does not fit
+		constexpr void set_growth(Grow grow) noexcept
+		{
+			m_Grow = grow;
+		}
+
+		// Move to another buffer, keeping the free and queued regions at the same offsets
+		// The reallocation receives the amount of bytes in use and returns the new buffer
+		template <typename Reallocate>
+		constexpr void reallocate(Reallocate&& reallocate)
+		{
+			size_t const read = size_t(m_ToRead.data() - m_Buffer.data());
+			size_t const used = size_t(m_Free.data() - m_Buffer.data());
+
+			m_Buffer = reallocate(used);
+
+			m_Free = m_Buffer.subspan(used);
+			m_ToRead = m_Buffer.subspan(read, used - read);
+		}
 	
 	private:
+
+		// Values bit_cast at once during constant evaluation, about 256 bytes
+		template <typename Val>
+		static constexpr size_t chunk_size = std::max<size_t>(1, 256 / sizeof(Val));
+		template <typename Val>
+		using Chunk = std::array<Val, chunk_size<Val>>;
+
+		// Plain byte loop, cheaper to constant evaluate than ranges algorithms
+		static constexpr void copy_bytes(std::byte const* src, std::byte* dest, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+				dest[i] = src[i];
+		}
+
+		// Write count values (up to a chunk) with a single bit_cast
+		template <typename Val>
+		constexpr void write_chunk(Val const* values, size_t count)
+		{
+			Chunk<Val> chunk{};
+			for (size_t i = 0; i < count; ++i)
+				chunk[i] = values[i];
+
+			copy_bytes(std::bit_cast<Bytes<Chunk<Val>>>(chunk).data(), m_Free.data(), count * sizeof(Val));
+			commit_write(count * sizeof(Val));
+		}
+		//
+		// Read count values (up to a chunk) with a single bit_cast
+		template <typename Val>
+		constexpr void read_chunk(Val* values, size_t count)
+		{
+			Bytes<Chunk<Val>> bytes{};
+			copy_bytes(m_ToRead.data(), bytes.data(), count * sizeof(Val));
+			commit_read(count * sizeof(Val));
+
+			auto const chunk = std::bit_cast<Chunk<Val>>(bytes);
+			for (size_t i = 0; i < count; ++i)
+				values[i] = chunk[i];
+		}
+
+		// Throw if count bytes do not fit, after trying to grow
+		constexpr void require_free(size_t count, char const* message)
+		{
+			if (count <= m_Free.size())
+				return;
+
+			if (m_Grow)
+				reallocate(
+					[this, count](size_t used)
+					{
+						return m_Grow(*this, used + count);
+					}
+				);
+
+			if (count > m_Free.size())
+				throw std::runtime_error{ message };
+		}
+
+		// Mark bytes in front of the free region as written
+		constexpr SerializerBase& commit_write(size_t count)
+		{
+			m_Free = m_Free.subspan(count);
+			m_ToRead = { m_ToRead.data(), m_Free.data() };
+
+			return *this;
+		}
+		//
+		// Mark bytes in front of the queued region as read
+		constexpr SerializerBase& commit_read(size_t count)
+		{
+			m_ToRead = m_ToRead.subspan(count);
+
+			return *this;
+		}
 	
 		std::span<std::byte> m_Buffer;
 
 		std::span<std::byte> m_Free;
 		std::span<std::byte> m_ToRead;
+
+		Grow m_Grow{};
 	
 	};
 
 }
 
-template <size_t EXTENT>
+template <size_t EXTENT, typename Allocator>
 class Serializer : private detail::SerializerBase
 {
 public:
@@ -231,6 +445,11 @@ public:
 
 	using SerializerBase::read;
 	using SerializerBase::write;
+	using SerializerBase::view;
+	using SerializerBase::size;
+	using SerializerBase::queued;
+	using SerializerBase::prepare;
+	using SerializerBase::commit;
 	using SerializerBase::clear;
 
 	// Empty
@@ -260,34 +479,74 @@ private:
 
 };
 
-template <>
-class Serializer<std::dynamic_extent> : private detail::SerializerBase
+template <typename Allocator>
+class Serializer<std::dynamic_extent, Allocator> : private detail::SerializerBase
 {
 public:
 
+	using allocator_type = Allocator;
+
 	// Copy
 	constexpr Serializer(Serializer const&) = delete;
 	constexpr Serializer& operator = (Serializer const&) = delete;
 
 	// Move
 	constexpr Serializer(Serializer&&) = default;
-	constexpr Serializer& operator = (Serializer&&) = default;
+	constexpr Serializer& operator = (Serializer&& other)
+	{
+		if (this == &other)
+			return *this;
+
+		SerializerBase::operator = (std::move(other));
+
+		// Unequal allocators that do not propagate copy the bytes, keep the regions in place
+		reallocate(
+			[this, &other](size_t)
+			{
+				m_Vector = std::move(other.m_Vector);
+				return std::span{ m_Vector };
+			}
+		);
+
+		m_Growth = other.m_Growth;
+		return *this;
+	}
 
 	using SerializerBase::read;
 	using SerializerBase::write;
+	using SerializerBase::view;
+	using SerializerBase::size;
+	using SerializerBase::queued;
+	using SerializerBase::prepare;
+	using SerializerBase::commit;
 	using SerializerBase::clear;
 
 	// A buffer of size 0 makes no sense
 	constexpr Serializer() = delete;
 
 	// With size
-	constexpr Serializer(size_t size)
-		: SerializerBase{/* no buffer */}, m_Vector(size)
+	constexpr Serializer(size_t size, Allocator const& allocator = Allocator{})
+		: SerializerBase{/* no buffer */}, m_Vector(size, allocator)
 	{
-		m_Vector.resize(size);
 		reset_buffer({ m_Vector.begin(), size });
 	}
 
+	// With initial size, growing when writes do not fit
+	constexpr Serializer(size_t size, SerializerGrowth growth, Allocator const& allocator = Allocator{})
+		: Serializer(size, allocator)
+	{
+		if (size > growth.max_capacity)
+			throw std::length_error{ "Initial size exceeds maximum capacity" };
+
+		m_Growth = growth;
+		set_growth(&Serializer::grow);
+	}
+
+	// Growing when writes do not fit
+	constexpr explicit Serializer(SerializerGrowth growth, Allocator const& allocator = Allocator{})
+		: Serializer(0, growth, allocator)
+	{}
+
 	// With size and default
 	template <typename Val> requires std::is_trivially_copyable_v<Val> && (!std::is_pointer_v<Val>)
 		constexpr Serializer(size_t size, std::initializer_list<Val> list)
@@ -314,10 +573,74 @@ public:
 		: Serializer{ std::size(source) * sizeof(Val), source }
 	{}
 
+
+	// Buffer size
+	constexpr size_t capacity() const noexcept
+	{
+		return m_Vector.size();
+	}
+
+	constexpr Allocator get_allocator() const noexcept
+	{
+		return m_Vector.get_allocator();
+	}
+
+	// Grow the buffer to at least capacity bytes
+	constexpr void reserve(size_t capacity)
+	{
+		if (capacity <= m_Vector.size())
+			return;
+
+		if (m_Growth && capacity > m_Growth->max_capacity)
+			throw std::length_error{ "Reserve exceeds maximum capacity" };
+
+		reallocate(
+			[this, capacity](size_t)
+			{
+				m_Vector.resize(capacity);
+				return std::span{ m_Vector };
+			}
+		);
+	}
+
+	// Shrink the buffer to the bytes written since the last clear
+	constexpr void shrink_to_fit()
+	{
+		reallocate(
+			[this](size_t used)
+			{
+				m_Vector.resize(used);
+				m_Vector.shrink_to_fit();
+				return std::span{ m_Vector };
+			}
+		);
+	}
+
 private:
 
+	// Growth hook
+	static constexpr std::span<std::byte> grow(SerializerBase& base, size_t required)
+	{
+		auto& self = static_cast<Serializer&>(base);
+		auto const& growth = *self.m_Growth;
+
+		if (required > growth.max_capacity)
+			return self.m_Vector; // Insufficient, write throws
+
+		auto const scaled = double(self.m_Vector.size()) * growth.factor;
+		auto const capacity = scaled < double(growth.max_capacity)
+			? std::max(required, size_t(scaled))
+			: growth.max_capacity;
+
+		self.m_Vector.resize(capacity);
+		return self.m_Vector;
+	}
+
 	// Buffer
-	std::vector<std::byte> m_Vector{};
+	std::vector<std::byte, Allocator> m_Vector{};
+
+	// Present when growing
+	std::optional<SerializerGrowth> m_Growth{};
 
 };
 
@@ -330,4 +653,8 @@ Serializer(std::array<T, EXT>) -> Serializer<EXT * sizeof(T)>;
 
 Serializer(size_t) -> Serializer<>;
 
+Serializer(size_t, SerializerGrowth) -> Serializer<>;
+
+Serializer(SerializerGrowth) -> Serializer<>;
+
 Serializer(int) -> Serializer<>;
@@ -0,0 +1,86 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "SerializerAggregate.h"
+
+#include <string>
+#include <vector>
+
+using serializer_helper::is_decomposable_v;
+using serializer_helper::tie_fields;
+
+namespace
+{
+	struct Empty {};
+
+	struct Point
+	{
+		int x, y;
+	};
+
+	struct Record
+	{
+		std::string name;
+		std::vector<Point> points;
+		Point origin;
+		double weight;
+	};
+
+	class Private
+	{
+		int m_Value;
+	};
+
+	struct Derived : Point
+	{
+		std::string name;
+	};
+
+	struct Tagged : Empty
+	{
+		std::string name;
+		int id;
+	};
+
+	struct Table
+	{
+		std::string name;
+		int cells[3];
+	};
+}
+
+static_assert(serializer_helper::detail::field_count<Point>() == 2, "Counting trivial fields");
+static_assert(serializer_helper::detail::field_count<Record>() == 4, "Counting non-trivial fields");
+
+static_assert(
+	is_decomposable_v<Record> 
+	&& is_decomposable_v<Point const>
+	&& !is_decomposable_v<Empty>
+	&& !is_decomposable_v<Private>
+	&& !is_decomposable_v<std::pair<int, int>>
+	&& !is_decomposable_v<int[2]>,
+	"Decomposable aggregates"
+);
+
+// Structured bindings see neither the fields of bases nor the elements of C-arrays
+static_assert(
+	!is_decomposable_v<Derived>
+	&& !is_decomposable_v<Tagged>
+	&& !is_decomposable_v<Table>,
+	"Bases and C-array fields"
+);
+
+static_assert(
+	[]
+	{
+		Record record{ "name", { { 1, 2 } }, { 3, 4 }, 2.5 };
+
+		auto [name, points, origin, weight] = tie_fields(record);
+		origin.y = 7;
+
+		return name == "name" && points.size() == 1 && weight == 2.5 
+			&& record.origin.y == 7;
+	}
+	(),
+	"Tying fields"
+);
@@ -0,0 +1,196 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <tuple>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+namespace serializer_helper
+{
+
+	namespace detail
+	{
+
+		// Most fields an aggregate can be decomposed into
+		constexpr size_t max_fields = 16;
+
+		// Converts to any field type, only used unevaluated
+		struct any_field
+		{
+			template <typename Field>
+			constexpr operator Field& () const noexcept;
+		};
+
+		template <typename Aggregate, size_t ... I>
+		constexpr bool is_initializable(std::index_sequence<I...>) noexcept
+		{
+			return requires { Aggregate{ (void(I), any_field{})... }; };
+		}
+
+		// Amount of fields, the most initializers the aggregate accepts
+		// C-array members take one initializer per element and are not supported
+		template <typename Aggregate, size_t N = 0>
+		constexpr size_t field_count() noexcept
+		{
+			if constexpr (N <= max_fields && is_initializable<Aggregate>(std::make_index_sequence<N + 1>{}))
+				return field_count<Aggregate, N + 1>();
+			else
+				return N;
+		}
+
+		// Converts to the base classes of an aggregate only
+		template <typename Aggregate>
+		struct any_base
+		{
+			template <typename Base> requires (std::is_base_of_v<Base, Aggregate> && !std::is_same_v<Base, Aggregate>)
+			constexpr operator Base& () const noexcept;
+		};
+
+		// Bases are initialized before the fields, and are counted as one
+		template <typename Aggregate>
+		constexpr bool has_base() noexcept
+		{
+			return requires { Aggregate{ any_base<Aggregate>{} }; };
+		}
+
+		// Parentheses initialize C-arrays from one array only, braces from their elements
+		template <typename Aggregate, size_t ... I>
+		constexpr bool is_paren_initializable(std::index_sequence<I...>) noexcept
+		{
+			return requires { Aggregate((void(I), any_field{})...); };
+		}
+
+		template <typename Aggregate>
+		constexpr bool has_array_field() noexcept
+		{
+#if defined(__cpp_aggregate_paren_init)
+			constexpr size_t count = field_count<Aggregate>();
+			return count > 1 && !is_paren_initializable<Aggregate>(std::make_index_sequence<count>{});
+#else
+			return false;
+#endif
+		}
+
+		template <typename, typename = void>
+		constexpr static bool is_tuple_like_v = false;
+
+		template <typename Tuple>
+		constexpr static bool is_tuple_like_v<Tuple, std::void_t<decltype(std::tuple_size<Tuple>::value)>> = true;
+
+	}
+
+	//
+	// Aggregates that can be decomposed into their fields
+	// Aggregates with base classes or C-array members are not
+	//
+	template <typename Object>
+	constexpr bool is_decomposable_v =
+		std::is_aggregate_v<std::remove_cv_t<Object>>
+		&& !std::is_array_v<std::remove_cv_t<Object>>
+		&& !detail::is_tuple_like_v<std::remove_cv_t<Object>>
+		&& detail::field_count<std::remove_cv_t<Object>>() != 0
+		&& !detail::has_base<std::remove_cv_t<Object>>()
+		&& !detail::has_array_field<std::remove_cv_t<Object>>();
+
+	//
+	// Tuple of references to the fields of an aggregate
+	//
+	template <typename Object> requires is_decomposable_v<Object>
+	constexpr auto tie_fields(Object& object) noexcept
+	{
+		constexpr size_t count = detail::field_count<std::remove_cv_t<Object>>();
+
+		static_assert(count <= detail::max_fields, "Aggregate has too many fields");
+
+		if constexpr (count == 1)
+		{
+			auto& [a] = object;
+			return std::tie(a);
+		}
+		else if constexpr (count == 2)
+		{
+			auto& [a, b] = object;
+			return std::tie(a, b);
+		}
+		else if constexpr (count == 3)
+		{
+			auto& [a, b, c] = object;
+			return std::tie(a, b, c);
+		}
+		else if constexpr (count == 4)
+		{
+			auto& [a, b, c, d] = object;
+			return std::tie(a, b, c, d);
+		}
+		else if constexpr (count == 5)
+		{
+			auto& [a, b, c, d, e] = object;
+			return std::tie(a, b, c, d, e);
+		}
+		else if constexpr (count == 6)
+		{
+			auto& [a, b, c, d, e, f] = object;
+			return std::tie(a, b, c, d, e, f);
+		}
+		else if constexpr (count == 7)
+		{
+			auto& [a, b, c, d, e, f, g] = object;
+			return std::tie(a, b, c, d, e, f, g);
+		}
+		else if constexpr (count == 8)
+		{
+			auto& [a, b, c, d, e, f, g, h] = object;
+			return std::tie(a, b, c, d, e, f, g, h);
+		}
+		else if constexpr (count == 9)
+		{
+			auto& [a, b, c, d, e, f, g, h, i] = object;
+			return std::tie(a, b, c, d, e, f, g, h, i);
+		}
+		else if constexpr (count == 10)
+		{
+			auto& [a, b, c, d, e, f, g, h, i, j] = object;
+			return std::tie(a, b, c, d, e, f, g, h, i, j);
+		}
+		else if constexpr (count == 11)
+		{
+			auto& [a, b, c, d, e, f, g, h, i, j, k] = object;
+			return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+		}
+		else if constexpr (count == 12)
+		{
+			auto& [a, b, c, d, e, f, g, h, i, j, k, l] = object;
+			return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
+		}
+		else if constexpr (count == 13)
+		{
+			auto& [a, b, c, d, e, f, g, h, i, j, k, l, m] = object;
+			return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m);
+		}
+		else if constexpr (count == 14)
+		{
+			auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n] = object;
+			return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n);
+		}
+		else if constexpr (count == 15)
+		{
+			auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n, o] = object;
+			return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o);
+		}
+		else if constexpr (count == 16)
+		{
+			auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p] = object;
+			return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p);
+		}
+	}
+
+	//
+	// Field types of an aggregate
+	//
+	template <typename Object>
+	using fields_t = decltype(tie_fields(std::declval<Object&>()));
+
+}
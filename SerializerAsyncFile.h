@@ -0,0 +1,355 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <cerrno>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <system_error>
+#include <condition_variable>
+
+#include "ConstexprSerializerBuffer.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace serializer_helper
+{
+
+	namespace detail
+	{
+		// Allocates on page boundaries, as direct I/O requires
+		template <typename T>
+		struct PageAllocator
+		{
+			using value_type = T;
+
+			static constexpr size_t alignment = 4096;
+
+			PageAllocator() = default;
+
+			template <typename U>
+			constexpr PageAllocator(PageAllocator<U> const&) noexcept
+			{}
+
+			T* allocate(size_t count)
+			{
+				return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ alignment }));
+			}
+
+			void deallocate(T* pointer, size_t) noexcept
+			{
+				::operator delete(pointer, std::align_val_t{ alignment });
+			}
+
+			template <typename U>
+			constexpr bool operator == (PageAllocator<U> const&) const noexcept
+			{
+				return true;
+			}
+		};
+	}
+
+	enum class eWriteMode
+	{
+		// Through the page cache
+		cached,
+		// Bypassing the page cache where supported (O_DIRECT), blocks and file offsets are page aligned
+		direct
+	};
+
+	//
+	// Asynchronous file writer
+	// Layouts are written into one of COUNT page aligned Serializer buffers of SIZE bytes,
+	// while a background thread writes the buffers filled before to the file in whole blocks.
+	// Writing only waits for the disk when all buffers are filled, memory stays bounded.
+	// flush() waits until everything written is in the file, sync() also makes it durable (fsync).
+	// Errors of the background thread are thrown by the next write, flush() or sync().
+	// The destructor flushes and closes the file, without reporting errors.
+	//
+	template <size_t SIZE = 1024 * 1024, size_t COUNT = 2>
+	class AsyncFileWriter
+	{
+
+		using Buffer = Serializer<std::dynamic_extent, detail::PageAllocator<std::byte>>;
+
+		static constexpr size_t alignment = detail::PageAllocator<std::byte>::alignment;
+
+		static_assert(SIZE != 0 && SIZE % alignment == 0, "Buffers are written in whole pages");
+		static_assert(COUNT >= 2, "One buffer is written while another is filled");
+
+	public:
+
+		// Create or truncate the file
+		explicit AsyncFileWriter(std::filesystem::path const& path, eWriteMode mode = eWriteMode::cached)
+			: m_Alignment{ mode == eWriteMode::direct ? alignment : 1 }
+		{
+			m_Buffers.reserve(COUNT);
+			for (size_t i = 0; i < COUNT; ++i)
+				m_Buffers.emplace_back(SIZE);
+
+			open(path, mode);
+
+			m_Thread = std::thread{ &AsyncFileWriter::run, this };
+		}
+
+		AsyncFileWriter(AsyncFileWriter const&) = delete;
+		AsyncFileWriter& operator = (AsyncFileWriter const&) = delete;
+
+		~AsyncFileWriter()
+		{
+			close();
+		}
+
+		AsyncFileWriter& write(char const* src, std::streamsize count)
+		{
+			return write(std::span{ reinterpret_cast<std::byte const*>(src), size_t(count) });
+		}
+		//
+		AsyncFileWriter& write(std::span<std::byte const> bytes)
+		{
+			while (!bytes.empty())
+			{
+				Buffer& buffer = current();
+				size_t const part = std::min(bytes.size(), SIZE - buffer.size());
+				buffer.write(bytes.first(part));
+				bytes = bytes.subspan(part);
+				m_Size += part;
+
+				if (buffer.size() == SIZE)
+					submit();
+			}
+
+			return *this;
+		}
+
+		// Wait until every written byte is in the file
+		void flush()
+		{
+			submit();
+			wait([this] { return m_Done == m_Submitted; });
+		}
+
+		// Flush, and wait until the file is on the disk
+		void sync()
+		{
+			flush();
+
+#if defined(_WIN32)
+			if (_commit(m_File) != 0)
+#else
+			if (::fsync(m_File) != 0)
+#endif
+				throw_error("Syncing file failed");
+		}
+
+		// Bytes written
+		uint64_t size() const noexcept
+		{
+			return m_Size;
+		}
+
+	private:
+
+		// Buffer written to the file
+		struct Pending
+		{
+			uint64_t offset;
+			size_t size;
+		};
+
+		[[noreturn]] static void throw_error(char const* message)
+		{
+			throw std::system_error{ errno, std::system_category(), message };
+		}
+
+		Buffer& current() noexcept
+		{
+			return m_Buffers[m_Submitted % COUNT];
+		}
+
+		// Wait for the background thread, and throw its error if any
+		template <typename Predicate>
+		void wait(Predicate predicate)
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_Written.wait(lock, predicate);
+
+			if (m_Error)
+				std::rethrow_exception(std::exchange(m_Error, nullptr));
+		}
+
+		// Hand the current buffer to the background thread, and continue in the next one once it is written
+		void submit()
+		{
+			Buffer& buffer = current();
+			size_t const used = buffer.size();
+			if (used == m_Carried)
+				return;
+
+			// A partial block in direct mode is written padded, and written again from the next buffer
+			size_t const tail = used % m_Alignment;
+			{
+				std::lock_guard lock{ m_Mutex };
+				m_Pending[m_Submitted % COUNT] = { m_Offset, used + (tail == 0 ? 0 : m_Alignment - tail) };
+				++m_Submitted;
+			}
+			m_Submit.notify_one();
+
+			m_Offset += used - tail;
+
+			wait([this] { return m_Submitted - m_Done < COUNT; });
+
+			Buffer& next = current();
+			next.clear();
+			next.write(buffer.queued().last(tail));
+			m_Carried = tail;
+		}
+
+		// Background thread, writes the submitted buffers in order
+		void run()
+		{
+			std::unique_lock lock{ m_Mutex };
+			while (true)
+			{
+				m_Submit.wait(lock, [this] { return m_Done != m_Submitted || m_Stop; });
+				if (m_Done == m_Submitted)
+					return;
+
+				Pending const pending = m_Pending[m_Done % COUNT];
+				std::byte const* const data = m_Buffers[m_Done % COUNT].queued().data();
+				lock.unlock();
+
+				std::exception_ptr error{};
+				try
+				{
+					write_at(data, pending.size, pending.offset);
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+
+				lock.lock();
+				if (error && !m_Error)
+					m_Error = error;
+
+				++m_Done;
+				m_Written.notify_all();
+			}
+		}
+
+		void write_at(std::byte const* data, size_t size, uint64_t offset)
+		{
+			while (size != 0)
+			{
+#if defined(_WIN32)
+				if (_lseeki64(m_File, int64_t(offset), SEEK_SET) < 0)
+					throw_error("Writing file failed");
+				int const done = _write(m_File, data, unsigned(std::min<size_t>(size, INT32_MAX)));
+#else
+				ssize_t const done = ::pwrite(m_File, data, size, off_t(offset));
+				if (done < 0 && errno == EINTR)
+					continue;
+#endif
+				if (done <= 0)
+					throw_error("Writing file failed");
+
+				data += done;
+				size -= size_t(done);
+				offset += uint64_t(done);
+			}
+		}
+
+		void open(std::filesystem::path const& path, eWriteMode mode)
+		{
+#if defined(_WIN32)
+			// Direct writes are not supported, the file is written through the cache
+			(void)mode;
+			m_File = _wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+			int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#if defined(O_DIRECT)
+			if (mode == eWriteMode::direct)
+				flags |= O_DIRECT;
+#else
+			(void)mode;
+#endif
+			m_File = ::open(path.c_str(), flags, 0644);
+#endif
+			if (m_File < 0)
+				throw_error("Opening file failed");
+		}
+
+		void close() noexcept
+		{
+			try
+			{
+				flush();
+			}
+			catch (...)
+			{
+			}
+
+			{
+				std::lock_guard lock{ m_Mutex };
+				m_Stop = true;
+			}
+			m_Submit.notify_one();
+			m_Thread.join();
+
+			// Drop the padding of the last block
+#if defined(_WIN32)
+			(void)_chsize_s(m_File, int64_t(m_Size));
+			_close(m_File);
+#else
+			if (m_Alignment != 1)
+				(void)::ftruncate(m_File, off_t(m_Size));
+			::close(m_File);
+#endif
+		}
+
+		size_t const m_Alignment;
+
+		int m_File{ -1 };
+
+		// Bytes written and file offset of the current buffer
+		uint64_t m_Size{}, m_Offset{};
+
+		// Bytes of the current buffer already written padded
+		size_t m_Carried{};
+
+		std::vector<Buffer> m_Buffers{};
+
+		// Buffers submitted and written, the current buffer is m_Submitted % COUNT
+		// Guarded by m_Mutex
+		std::array<Pending, COUNT> m_Pending{};
+		size_t m_Submitted{}, m_Done{};
+		bool m_Stop{};
+		std::exception_ptr m_Error{};
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Submit{}, m_Written{};
+
+		std::thread m_Thread{};
+
+	};
+
+}
@@ -0,0 +1,36 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "SerializerByteOrder.h"
+
+#include <cstdint>
+
+using serializer_helper::byteswap;
+
+static_assert(
+	byteswap(uint16_t{ 0x1234 }) == 0x3412
+	&& byteswap(uint32_t{ 0x12345678 }) == 0x78563412
+	&& byteswap(uint64_t{ 0x0123456789ABCDEF }) == 0xEFCDAB8967452301
+	&& byteswap('a') == 'a',
+	"Swapping scalars"
+);
+
+static_assert(
+	[]
+	{
+		std::array<std::array<uint16_t, 2>, 3> values{ { { 0x0102, 0x0304 }, { 0x0506, 0x0708 }, { 0x090A, 0x0B0C } } };
+
+		byteswap(std::span{ values });
+		bool const swapped = values[1][1] == 0x0807;
+
+		// Twice is identity
+		byteswap(std::span{ values });
+
+		return swapped
+			&& byteswap(2.5) != 2.5
+			&& byteswap(byteswap(2.5)) == 2.5
+			&& values[2][0] == 0x090A;
+	}
+	(),
+	"Swapping arrays"
+);
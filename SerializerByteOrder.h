@@ -0,0 +1,139 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <bit>
+#include <span>
+#include <array>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace serializer_helper
+{
+
+	namespace detail
+	{
+		template <typename>
+		constexpr static bool is_std_array_v = false;
+
+		template <typename T, size_t N>
+		constexpr static bool is_std_array_v<std::array<T, N>> = true;
+
+		template <typename Val, typename = void>
+		struct scalar
+		{
+			using type = Val;
+		};
+
+		template <typename Val>
+		struct scalar<Val, std::enable_if_t<is_std_array_v<Val>>> : scalar<typename Val::value_type> {};
+
+		// Scalar an object consists of, itself if not an array
+		template <typename Val>
+		using scalar_t = typename scalar<std::remove_cv_t<Val>>::type;
+	}
+
+	//
+	// Objects with a byte order: arithmetic, enums and (nested) std::arrays of those
+	//
+	template <typename Val>
+	constexpr bool has_byte_order_v = std::is_arithmetic_v<detail::scalar_t<Val>> || std::is_enum_v<detail::scalar_t<Val>>;
+
+	//
+	// Reverse the bytes of each scalar in a value
+	//
+	template <typename Val> requires has_byte_order_v<Val>
+	constexpr Val byteswap(Val const& value) noexcept
+	{
+		constexpr size_t size = sizeof(detail::scalar_t<Val>);
+
+		if constexpr (size == 1)
+		{
+			return value;
+		}
+		else
+		{
+			auto bytes = std::bit_cast<std::array<std::byte, sizeof(Val)>>(value);
+			for (auto it = bytes.begin(); it != bytes.end(); it += size)
+				std::reverse(it, it + size);
+			return std::bit_cast<Val>(bytes);
+		}
+	}
+
+	namespace detail
+	{
+		// Shuffle mask reversing each group of Size bytes in 16 bytes
+		template <size_t Size>
+		constexpr auto swap_mask = []
+		{
+			std::array<char, 16> mask{};
+			for (size_t i = 0; i < mask.size(); ++i)
+				mask[i] = char(i / Size * Size + (Size - 1 - i % Size));
+			return mask;
+		}();
+
+		// Reverse each group of Size bytes, count groups
+		template <size_t Size>
+		inline void byteswap_bytes(std::byte* const data, size_t const count) noexcept
+		{
+			size_t const bytes = count * Size;
+			size_t i = 0;
+
+#if defined(__AVX2__)
+			__m128i const half = _mm_loadu_si128(reinterpret_cast<__m128i const*>(swap_mask<Size>.data()));
+			__m256i const mask = _mm256_broadcastsi128_si256(half);
+			for (; i + 32 <= bytes; i += 32)
+			{
+				auto const block = reinterpret_cast<__m256i*>(data + i);
+				_mm256_storeu_si256(block, _mm256_shuffle_epi8(_mm256_loadu_si256(block), mask));
+			}
+#endif
+#if defined(__AVX2__) || defined(__SSSE3__)
+			__m128i const mask16 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(swap_mask<Size>.data()));
+			for (; i + 16 <= bytes; i += 16)
+			{
+				auto const block = reinterpret_cast<__m128i*>(data + i);
+				_mm_storeu_si128(block, _mm_shuffle_epi8(_mm_loadu_si128(block), mask16));
+			}
+#endif
+
+			for (; i < bytes; i += Size)
+				std::reverse(data + i, data + i + Size);
+		}
+	}
+
+	//
+	// Reverse the bytes of each scalar in values, in place
+	// Vectorised outside of constant evaluation when SSSE3 or AVX2 is enabled
+	//
+	template <typename Val, size_t EXTENT> requires has_byte_order_v<Val>
+	constexpr void byteswap(std::span<Val, EXTENT> const values) noexcept
+	{
+		constexpr size_t size = sizeof(detail::scalar_t<Val>);
+
+		if constexpr (size != 1)
+		{
+			if (std::is_constant_evaluated())
+			{
+				for (auto& value : values)
+					value = byteswap(value);
+			}
+			else
+			{
+				detail::byteswap_bytes<size>(
+					reinterpret_cast<std::byte*>(values.data()),
+					values.size_bytes() / size
+				);
+			}
+		}
+	}
+
+}
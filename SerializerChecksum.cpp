@@ -0,0 +1,86 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerChecksum.h"
+#include "SerializerCompression.h"
+
+#include <string>
+#include <vector>
+#include <string_view>
+
+using serializer_helper::Layout;
+using serializer_helper::crc32c;
+using serializer_helper::ChecksumStream;
+using serializer_helper::CompressedStream;
+using serializer_helper::LzCodec;
+
+namespace
+{
+	constexpr std::vector<std::byte> bytes_of(std::string_view string)
+	{
+		std::vector<std::byte> bytes;
+		for (char c : string)
+			bytes.push_back(std::byte(c));
+		return bytes;
+	}
+}
+
+static_assert(
+	[]
+	{
+		auto const check = bytes_of("123456789");
+		std::span<std::byte const> const bytes{ check };
+
+		// Standard check value, and continued over parts
+		return crc32c(bytes) == 0xE3069283
+			&& crc32c(bytes.subspan(4), crc32c(bytes.first(4))) == 0xE3069283
+			&& crc32c({}) == 0;
+	}
+	(),
+	"CRC32C"
+);
+
+static_assert(
+	[]
+	{
+		std::vector<std::string> names{ "zero", "one", "two", "three" };
+
+		Serializer io(SerializerGrowth{});
+		{
+			// Small blocks, the vector spans several
+			ChecksumStream<Serializer<>, 8> checked{ io };
+			Layout<std::vector<std::string>, int>::Write(checked, names, 7);
+		}
+
+		ChecksumStream<Serializer<>, 8> checked{ io };
+		auto const [replica, after] = Layout<std::vector<std::string>, int>::Read(checked);
+
+		return replica == names && after == 7 && io.size() == 0;
+	}
+	(),
+	"Checksummed stream"
+);
+
+static_assert(
+	[]
+	{
+		std::vector<std::string> names(20, "a name that repeats");
+
+		// Compressed blocks are checked before they are decompressed
+		Serializer io(SerializerGrowth{});
+		{
+			ChecksumStream<Serializer<>, 64> checked{ io };
+			CompressedStream<LzCodec, ChecksumStream<Serializer<>, 64>, 128> compressed{ checked };
+			Layout<std::vector<std::string>>::Write(compressed, names);
+		}
+
+		ChecksumStream<Serializer<>, 64> checked{ io };
+		CompressedStream<LzCodec, ChecksumStream<Serializer<>, 64>, 128> compressed{ checked };
+		auto const [replica] = Layout<std::vector<std::string>>::Read(compressed);
+
+		return replica == names;
+	}
+	(),
+	"Checksummed compressed stream"
+);
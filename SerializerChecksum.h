@@ -0,0 +1,376 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#include "SerializerIostreamHelper.h"
+
+#if (defined(__SSE4_2__) || defined(__AVX__)) && (defined(__x86_64__) || defined(_M_X64))
+#define SERIALIZER_CRC32C_SSE42
+#include <nmmintrin.h>
+#endif
+
+namespace serializer_helper
+{
+
+	namespace detail
+	{
+		// Tables of the reflected CRC32C (Castagnoli) polynomial, slicing by 8
+		constexpr auto crc32c_tables = []
+		{
+			std::array<std::array<uint32_t, 256>, 8> tables{};
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				uint32_t crc = i;
+				for (int bit = 0; bit < 8; ++bit)
+					crc = crc & 1 ? crc >> 1 ^ 0x82F63B78 : crc >> 1;
+				tables[0][i] = crc;
+			}
+			for (size_t k = 1; k < tables.size(); ++k)
+				for (size_t i = 0; i < 256; ++i)
+					tables[k][i] = tables[k - 1][i] >> 8 ^ tables[0][tables[k - 1][i] & 0xFF];
+			return tables;
+		}();
+
+		constexpr uint32_t crc32c_byte(uint32_t crc, uint8_t byte) noexcept
+		{
+			return crc >> 8 ^ crc32c_tables[0][(crc ^ byte) & 0xFF];
+		}
+
+		// Update the (not inverted) register with count bytes
+		// With the crc32 instruction when SSE4.2 is enabled, 8 bytes at a time from tables otherwise
+		inline uint32_t crc32c_bytes(std::byte const* data, size_t count, uint32_t crc) noexcept
+		{
+#if defined(SERIALIZER_CRC32C_SSE42)
+			for (; count >= sizeof(uint64_t); data += sizeof(uint64_t), count -= sizeof(uint64_t))
+			{
+				uint64_t word;
+				std::memcpy(&word, data, sizeof(word));
+				crc = uint32_t(_mm_crc32_u64(crc, word));
+			}
+			for (; count != 0; ++data, --count)
+				crc = _mm_crc32_u8(crc, uint8_t(*data));
+#else
+			auto const& t = crc32c_tables;
+			auto const word = [](std::byte const* bytes)
+			{
+				return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+			};
+			for (; count >= 8; data += 8, count -= 8)
+			{
+				uint32_t const low = crc ^ word(data), high = word(data + 4);
+				crc = t[7][low & 0xFF] ^ t[6][low >> 8 & 0xFF] ^ t[5][low >> 16 & 0xFF] ^ t[4][low >> 24]
+					^ t[3][high & 0xFF] ^ t[2][high >> 8 & 0xFF] ^ t[1][high >> 16 & 0xFF] ^ t[0][high >> 24];
+			}
+			for (; count != 0; ++data, --count)
+				crc = crc32c_byte(crc, uint8_t(*data));
+#endif
+			return crc;
+		}
+
+		// Copy count bytes and update the (not inverted) register with them in the same pass
+		template <typename Src, typename Dst>
+		constexpr uint32_t copy_crc32c(Src const* src, Dst* dest, size_t count, uint32_t crc) noexcept
+		{
+			if (std::is_constant_evaluated())
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					crc = crc32c_byte(crc, uint8_t(src[i]));
+					dest[i] = Dst(src[i]);
+				}
+				return crc;
+			}
+
+			auto from = reinterpret_cast<std::byte const*>(src);
+			auto to = reinterpret_cast<std::byte*>(dest);
+
+#if defined(SERIALIZER_CRC32C_SSE42)
+			for (; count >= sizeof(uint64_t); from += sizeof(uint64_t), to += sizeof(uint64_t), count -= sizeof(uint64_t))
+			{
+				uint64_t word;
+				std::memcpy(&word, from, sizeof(word));
+				std::memcpy(to, &word, sizeof(word));
+				crc = uint32_t(_mm_crc32_u64(crc, word));
+			}
+#endif
+			// In parts that are still cached when summed
+			for (size_t part; count != 0; from += part, to += part, count -= part)
+			{
+				part = std::min<size_t>(count, 4096);
+				std::memcpy(to, from, part);
+				crc = crc32c_bytes(to, part, crc);
+			}
+
+			return crc;
+		}
+
+		// Bytes to or from a stream
+		// iostreams through sputn/sgetn on their rdbuf(), other streams through write/read of a byte range
+		template <typename Stream>
+		constexpr bool put_bytes(Stream& stream, std::span<std::byte const> bytes)
+		{
+			if constexpr (has_streambuf_v<Stream>)
+				return stream.rdbuf()->sputn(reinterpret_cast<char const*>(bytes.data()), std::ssize(bytes)) == std::ssize(bytes);
+			else
+			{
+				stream.write(std::span<std::byte const>{ bytes });
+				return true;
+			}
+		}
+
+		template <typename Stream>
+		constexpr bool get_bytes(Stream& stream, std::span<std::byte> bytes)
+		{
+			if constexpr (has_streambuf_v<Stream>)
+				return stream.rdbuf()->sgetn(reinterpret_cast<char*>(bytes.data()), std::ssize(bytes)) == std::ssize(bytes);
+			else
+			{
+				// As a range, not as a single span value
+				stream.read(std::span<std::byte>{ bytes });
+				return true;
+			}
+		}
+
+		// Read bytes and update the (not inverted) register with them in the same pass
+		// Copied from a view of buffers, summed in parts straight after reading them otherwise
+		template <typename Stream>
+		constexpr bool get_checked(Stream& stream, std::span<std::byte> bytes, uint32_t& crc)
+		{
+			if constexpr (is_viewable_v<Stream>)
+			{
+				crc = copy_crc32c(stream.view(bytes.size()).data(), bytes.data(), bytes.size(), crc);
+				return true;
+			}
+			else
+			{
+				for (size_t done = 0, part; done != bytes.size(); done += part)
+				{
+					part = std::min<size_t>(bytes.size() - done, 4096);
+					if (!get_bytes(stream, bytes.subspan(done, part)))
+						return false;
+
+					if (std::is_constant_evaluated())
+						for (std::byte byte : bytes.subspan(done, part))
+							crc = crc32c_byte(crc, uint8_t(byte));
+					else
+						crc = crc32c_bytes(bytes.data() + done, part, crc);
+				}
+				return true;
+			}
+		}
+	}
+
+	//
+	// CRC32C (Castagnoli) of bytes, continuing the checksum of the bytes in front of them
+	// crc32c(b, crc32c(a)) is the checksum of a followed by b
+	//
+	constexpr uint32_t crc32c(std::span<std::byte const> bytes, uint32_t crc = 0) noexcept
+	{
+		crc = ~crc;
+
+		if (std::is_constant_evaluated())
+			for (std::byte byte : bytes)
+				crc = detail::crc32c_byte(crc, uint8_t(byte));
+		else
+			crc = detail::crc32c_bytes(bytes.data(), bytes.size(), crc);
+
+		return ~crc;
+	}
+
+	//
+	// Checksummed stream
+	// Frames blocks of up to SIZE bytes with their size and CRC32C (4 bytes little endian each).
+	// Written bytes are summed while they are staged. A read block is summed in the same pass that reads it,
+	// and is checked before any of it is read: torn or corrupt blocks throw std::runtime_error instead of producing objects.
+	// Reading past the end fails like BufferedStream.
+	// Use for reading or writing, not both, with the SIZE it was written with.
+	// Written bytes are flushed as a block on flush() and destruction, only flush() reports errors.
+	//
+	template <typename Stream, size_t SIZE = 64 * 1024>
+	class ChecksumStream
+	{
+
+		static_assert(SIZE != 0 && SIZE <= UINT32_MAX, "Block sizes are stored in 4 bytes");
+
+	public:
+
+		constexpr explicit ChecksumStream(Stream& stream)
+			: m_Stream{ stream }
+		{}
+
+		ChecksumStream(ChecksumStream const&) = delete;
+		ChecksumStream& operator = (ChecksumStream const&) = delete;
+
+		constexpr ~ChecksumStream()
+		{
+			if constexpr (detail::has_streambuf_v<Stream> || detail::is_writable_v<Stream>)
+				if (m_Put != 0)
+					try
+					{
+						flush();
+					}
+					catch (...)
+					{
+					}
+		}
+
+		// Read-only over read-only streams
+		constexpr ChecksumStream& write(char const* src, std::streamsize count) requires (detail::has_streambuf_v<Stream> || detail::is_writable_v<Stream>)
+		{
+			return stage(src, size_t(count));
+		}
+		//
+		constexpr ChecksumStream& write(std::span<std::byte const> src) requires (detail::has_streambuf_v<Stream> || detail::is_writable_v<Stream>)
+		{
+			return stage(src.data(), src.size());
+		}
+
+		constexpr ChecksumStream& read(char* dest, std::streamsize count)
+		{
+			return serve(dest, size_t(count));
+		}
+		//
+		constexpr ChecksumStream& read(std::span<std::byte> dest)
+		{
+			return serve(dest.data(), dest.size());
+		}
+
+		// Write the staged bytes as a block
+		constexpr void flush()
+		{
+			if (m_Put == 0)
+				return;
+
+			std::array<std::byte, header_size> header{};
+			for (size_t i = 0; i < 4; ++i)
+			{
+				header[i] = std::byte(m_Put >> (i * 8));
+				header[4 + i] = std::byte(~m_Crc >> (i * 8));
+			}
+
+			if (!detail::put_bytes(m_Stream, header) || !detail::put_bytes(m_Stream, std::span{ m_Block }.first(m_Put)))
+				fail("Checksum stream failed");
+
+			m_Put = 0;
+			m_Crc = ~uint32_t{};
+		}
+
+	private:
+
+		static constexpr size_t header_size = 8;
+
+		template <typename Src>
+		constexpr ChecksumStream& stage(Src const* src, size_t count)
+		{
+			while (count != 0)
+			{
+				size_t const part = std::min(count, SIZE - m_Put);
+				m_Crc = detail::copy_crc32c(src, m_Block.data() + m_Put, part, m_Crc);
+				m_Put += part;
+				src += part;
+				count -= part;
+
+				if (m_Put == SIZE)
+					flush();
+			}
+
+			return *this;
+		}
+
+		template <typename Dst>
+		constexpr ChecksumStream& serve(Dst* dest, size_t count)
+		{
+			while (count != 0)
+			{
+				if (m_Begin == m_End && !next())
+					break;
+
+				size_t const part = std::min(count, m_End - m_Begin);
+				if (std::is_constant_evaluated())
+					std::transform(m_Block.data() + m_Begin, m_Block.data() + m_Begin + part, dest, [](std::byte byte) { return Dst(byte); });
+				else
+					std::memcpy(dest, m_Block.data() + m_Begin, part);
+
+				m_Begin += part;
+				dest += part;
+				count -= part;
+			}
+
+			return *this;
+		}
+
+		// Read and check the next block
+		constexpr bool next()
+		{
+			std::array<std::byte, header_size> header{};
+
+			// The end of the stream or a torn header
+			if constexpr (detail::has_streambuf_v<Stream>)
+			{
+				auto const got = m_Stream.rdbuf()->sgetn(reinterpret_cast<char*>(header.data()), std::ssize(header));
+				if (got == 0)
+				{
+					fail("Checksum stream failed");
+					return false;
+				}
+				if (got != std::ssize(header))
+					corrupt();
+			}
+			else
+				detail::get_bytes(m_Stream, header);
+
+			size_t size{};
+			uint32_t expected{};
+			for (size_t i = 0; i < 4; ++i)
+			{
+				size |= size_t(header[i]) << (i * 8);
+				expected |= uint32_t(header[4 + i]) << (i * 8);
+			}
+
+			uint32_t crc = ~uint32_t{};
+			if (size > SIZE || !detail::get_checked(m_Stream, std::span{ m_Block }.first(size), crc) || ~crc != expected)
+				corrupt();
+
+			m_Begin = 0;
+			m_End = size;
+			return true;
+		}
+
+		constexpr void fail(char const* what)
+		{
+			if constexpr (detail::has_streambuf_v<Stream>)
+				m_Stream.setstate(std::ios_base::failbit);
+			else
+				throw std::runtime_error{ what };
+		}
+
+		// Not left to the stream state, the objects would be decoded from garbage
+		[[noreturn]] void corrupt()
+		{
+			m_Begin = m_End = 0;
+			throw std::runtime_error{ "Torn or corrupt checksummed block" };
+		}
+
+		Stream& m_Stream;
+
+		std::array<std::byte, SIZE> m_Block{};
+
+		// Staged bytes to write and their running checksum
+		size_t m_Put{};
+		uint32_t m_Crc{ ~uint32_t{} };
+
+		// Checked bytes to read
+		size_t m_Begin{}, m_End{};
+
+	};
+
+}
@@ -0,0 +1,98 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerCompression.h"
+
+#include <string>
+#include <vector>
+
+using serializer_helper::Layout;
+using serializer_helper::RleCodec;
+using serializer_helper::LzCodec;
+using serializer_helper::CompressedStream;
+
+namespace
+{
+
+	// Compresses and restores bytes, the compressed size or 0 when they did not round trip
+	template <typename Codec>
+	constexpr size_t round_trip(std::vector<std::byte> const& bytes)
+	{
+		std::vector<std::byte> packed(Codec::bound(bytes.size()));
+		packed.resize(Codec::compress(bytes, packed));
+
+		std::vector<std::byte> restored(bytes.size());
+		Codec::decompress(packed, restored);
+
+		return restored == bytes ? packed.size() : 0;
+	}
+
+	// Runs, a repeated phrase and noise
+	constexpr std::vector<std::byte> sample()
+	{
+		std::vector<std::byte> bytes(300, std::byte{ 'a' });
+		for (char c : std::string_view{ "compress me, compress me again, compress me once more" })
+			bytes.push_back(std::byte(c));
+		for (uint32_t i = 0, x = 2022; i < 100; ++i)
+			bytes.push_back(std::byte((x = x * 1103515245 + 12345) >> 16));
+		return bytes;
+	}
+
+}
+
+static_assert(
+	[]
+	{
+		auto const bytes = sample();
+		size_t const rle = round_trip<RleCodec>(bytes);
+		size_t const lz = round_trip<LzCodec>(bytes);
+
+		return rle != 0 && rle < bytes.size() && lz != 0 && lz < rle;
+	}
+	(),
+	"Codec round trip"
+);
+
+static_assert(
+	[]
+	{
+		std::vector<std::string> names(50, "a name that repeats");
+		names.push_back("and one that does not");
+
+		Serializer io(SerializerGrowth{});
+		{
+			// Small blocks, the vector spans several
+			CompressedStream<LzCodec, Serializer<>, 256> compressed{ io };
+			Layout<std::vector<std::string>, int>::Write(compressed, names, 7);
+		}
+		size_t const size = io.size();
+
+		CompressedStream<LzCodec, Serializer<>, 256> compressed{ io };
+		auto const [replica, after] = Layout<std::vector<std::string>, int>::Read(compressed);
+
+		return replica == names && after == 7 && size < names.size() * names.front().size();
+	}
+	(),
+	"Compressed stream"
+);
+
+static_assert(
+	[]
+	{
+		Serializer io(SerializerGrowth{});
+		{
+			// Nothing to compress, stored as is
+			CompressedStream<RleCodec, Serializer<>> compressed{ io };
+			Layout<int, int>::Write(compressed, 1, 2);
+		}
+		size_t const size = io.size();
+
+		CompressedStream<RleCodec, Serializer<>> compressed{ io };
+		auto const [a, b] = Layout<int, int>::Read(compressed);
+
+		return size == 9 + 2 * sizeof(int) && a == 1 && b == 2;
+	}
+	(),
+	"Stored block"
+);
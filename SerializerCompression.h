@@ -0,0 +1,480 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <vector>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerIostreamHelper.h"
+#include "SerializerChecksum.h"
+
+namespace serializer_helper
+{
+
+	namespace detail
+	{
+
+		constexpr void copy_bytes(std::span<std::byte const> src, std::byte* dest)
+		{
+			if (std::is_constant_evaluated())
+				std::ranges::copy(src, dest);
+			else if (!src.empty())
+				std::memcpy(dest, src.data(), src.size());
+		}
+
+		[[noreturn]] inline void corrupt_block()
+		{
+			throw std::runtime_error{ "Corrupt compressed block" };
+		}
+
+	}
+
+	//
+	// Codecs
+	// compress writes at most bound(size) bytes and returns the amount written,
+	// decompress fills dest exactly or throws on corrupt input.
+	//
+
+	// Runs of 3 to 130 equal bytes as 2 bytes, other bytes as literals of up to 128
+	struct RleCodec
+	{
+		static constexpr uint8_t id = 1;
+
+		static constexpr size_t bound(size_t size) noexcept
+		{
+			return size + size / 128 + 1;
+		}
+
+		static constexpr size_t compress(std::span<std::byte const> src, std::span<std::byte> dest)
+		{
+			size_t in{}, out{}, literal{};
+
+			auto const flush_literals = [&]
+			{
+				while (literal != in)
+				{
+					size_t const count = std::min<size_t>(in - literal, 128);
+					dest[out++] = std::byte(count - 1);
+					detail::copy_bytes(src.subspan(literal, count), dest.data() + out);
+					out += count;
+					literal += count;
+				}
+			};
+
+			while (in < src.size())
+			{
+				size_t run{ 1 };
+				while (in + run < src.size() && run < 130 && src[in + run] == src[in])
+					++run;
+
+				if (run >= 3)
+				{
+					flush_literals();
+					dest[out++] = std::byte(run + 125);
+					dest[out++] = src[in];
+					literal = in += run;
+				}
+				else
+					in += run;
+			}
+
+			flush_literals();
+			return out;
+		}
+
+		static constexpr void decompress(std::span<std::byte const> src, std::span<std::byte> dest)
+		{
+			size_t in{}, out{};
+			while (in < src.size())
+			{
+				size_t const control = size_t(src[in++]);
+				if (control < 128)
+				{
+					size_t const count = control + 1;
+					if (count > src.size() - in || count > dest.size() - out)
+						detail::corrupt_block();
+
+					detail::copy_bytes(src.subspan(in, count), dest.data() + out);
+					in += count;
+					out += count;
+				}
+				else
+				{
+					size_t const count = control - 125;
+					if (in == src.size() || count > dest.size() - out)
+						detail::corrupt_block();
+
+					std::fill_n(dest.data() + out, count, src[in++]);
+					out += count;
+				}
+			}
+
+			if (out != dest.size())
+				detail::corrupt_block();
+		}
+	};
+
+	// LZ77 with a 64 KB window, in the style of LZ4
+	// Sequences of a token (literal count and match length nibbles), literals, a 2 byte offset and length extensions.
+	// The last sequence holds literals only.
+	struct LzCodec
+	{
+		static constexpr uint8_t id = 2;
+
+		static constexpr size_t bound(size_t size) noexcept
+		{
+			return size + size / 255 + 16;
+		}
+
+		static constexpr size_t compress(std::span<std::byte const> src, std::span<std::byte> dest)
+		{
+			// Last position + 1 of a hashed 4 byte sequence, 0 when empty
+			std::array<uint32_t, 1 << hash_bits> table{};
+
+			size_t in{}, out{}, anchor{};
+			while (in + min_match <= src.size())
+			{
+				uint32_t const sequence = load(src, in);
+				uint32_t& slot = table[hash(sequence)];
+				size_t const candidate = slot;
+				slot = uint32_t(in + 1);
+
+				if (candidate == 0 || in - (candidate - 1) > max_offset || load(src, candidate - 1) != sequence)
+				{
+					// Step further the longer nothing matches
+					in += 1 + ((in - anchor) >> 6);
+					continue;
+				}
+
+				size_t const match = candidate - 1;
+				size_t const length = min_match + match_length(src, match + min_match, in + min_match);
+
+				out = put_literals(dest, out, src.subspan(anchor, in - anchor), length - min_match);
+
+				dest[out++] = std::byte((in - match) & 0xFF);
+				dest[out++] = std::byte((in - match) >> 8);
+				if (length - min_match >= 15)
+					out = put_length(dest, out, length - min_match - 15);
+
+				in += length;
+				anchor = in;
+			}
+
+			return put_literals(dest, out, src.subspan(anchor), 0);
+		}
+
+		static constexpr void decompress(std::span<std::byte const> src, std::span<std::byte> dest)
+		{
+			size_t in{}, out{};
+			while (true)
+			{
+				if (in == src.size())
+					detail::corrupt_block();
+
+				size_t const token = size_t(src[in++]);
+
+				size_t literals{ token >> 4 };
+				if (literals == 15)
+					literals += get_length(src, in);
+
+				if (literals > src.size() - in || literals > dest.size() - out)
+					detail::corrupt_block();
+
+				detail::copy_bytes(src.subspan(in, literals), dest.data() + out);
+				in += literals;
+				out += literals;
+
+				if (in == src.size())
+					break;
+
+				if (src.size() - in < 2)
+					detail::corrupt_block();
+
+				size_t const offset = size_t(src[in]) | size_t(src[in + 1]) << 8;
+				in += 2;
+
+				size_t length{ token & 15 };
+				if (length == 15)
+					length += get_length(src, in);
+				length += min_match;
+
+				if (offset == 0 || offset > out || length > dest.size() - out)
+					detail::corrupt_block();
+
+				// Forward, matches may overlap what they produce
+				if (offset >= length)
+					detail::copy_bytes(dest.subspan(out - offset, length), dest.data() + out);
+				else
+					for (size_t i = 0; i < length; ++i)
+						dest[out + i] = dest[out - offset + i];
+				out += length;
+			}
+
+			if (out != dest.size())
+				detail::corrupt_block();
+		}
+
+	private:
+
+		static constexpr size_t hash_bits = 12;
+		static constexpr size_t min_match = 4;
+		static constexpr size_t max_offset = 0xFFFF;
+
+		// In host byte order outside of constant evaluation, sequences are only hashed and compared
+		static constexpr uint32_t load(std::span<std::byte const> src, size_t at) noexcept
+		{
+			if (!std::is_constant_evaluated())
+			{
+				uint32_t value;
+				std::memcpy(&value, src.data() + at, sizeof(value));
+				return value;
+			}
+			return uint32_t(src[at]) | uint32_t(src[at + 1]) << 8 | uint32_t(src[at + 2]) << 16 | uint32_t(src[at + 3]) << 24;
+		}
+
+		// Equal bytes at match and in, 8 at a time outside of constant evaluation
+		static constexpr size_t match_length(std::span<std::byte const> src, size_t match, size_t in) noexcept
+		{
+			size_t length{};
+			if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+				for (uint64_t a, b; in + length + sizeof(uint64_t) <= src.size(); length += sizeof(uint64_t))
+				{
+					std::memcpy(&a, src.data() + match + length, sizeof(a));
+					std::memcpy(&b, src.data() + in + length, sizeof(b));
+					if (a != b)
+						return length + size_t(std::countr_zero(a ^ b)) / 8;
+				}
+
+			while (in + length < src.size() && src[match + length] == src[in + length])
+				++length;
+			return length;
+		}
+
+		static constexpr size_t hash(uint32_t sequence) noexcept
+		{
+			return (sequence * 2654435761u) >> (32 - hash_bits);
+		}
+
+		// Extension bytes of a length beyond its nibble
+		static constexpr size_t put_length(std::span<std::byte> dest, size_t out, size_t length)
+		{
+			for (; length >= 255; length -= 255)
+				dest[out++] = std::byte{ 255 };
+			dest[out++] = std::byte(length);
+			return out;
+		}
+
+		static constexpr size_t get_length(std::span<std::byte const> src, size_t& in)
+		{
+			size_t length{};
+			std::byte extension{};
+			do
+			{
+				if (in == src.size())
+					detail::corrupt_block();
+
+				extension = src[in++];
+				length += size_t(extension);
+			} while (extension == std::byte{ 255 });
+
+			return length;
+		}
+
+		// Token and literals of a sequence
+		static constexpr size_t put_literals(std::span<std::byte> dest, size_t out, std::span<std::byte const> literals, size_t match)
+		{
+			dest[out++] = std::byte(std::min<size_t>(literals.size(), 15) << 4 | std::min<size_t>(match, 15));
+			if (literals.size() >= 15)
+				out = put_length(dest, out, literals.size() - 15);
+
+			detail::copy_bytes(literals, dest.data() + out);
+			return out + literals.size();
+		}
+	};
+
+	//
+	// Compressed stream
+	// Compresses blocks of up to SIZE bytes with Codec before they reach the stream, and decompresses them on read.
+	// Blocks are framed as the raw size and the stored size (4 bytes little endian each) and the codec id,
+	// blocks that do not compress are stored as is (codec 0).
+	// Read blocks are decompressed straight into a Serializer buffer.
+	// Use for reading or writing, not both, with the SIZE it was written with.
+	// Written bytes are flushed as a block on flush() and destruction, only flush() reports errors.
+	//
+	template <typename Codec, typename Stream, size_t SIZE = 64 * 1024>
+	class CompressedStream
+	{
+
+		static_assert(SIZE != 0 && SIZE <= UINT32_MAX, "Block sizes are stored in 4 bytes");
+	public:
+
+		constexpr explicit CompressedStream(Stream& stream)
+			: m_Stream{ stream }
+			, m_Block(SIZE)
+		{}
+
+		CompressedStream(CompressedStream const&) = delete;
+		CompressedStream& operator = (CompressedStream const&) = delete;
+
+		constexpr ~CompressedStream()
+		{
+			if constexpr (detail::has_streambuf_v<Stream> || detail::is_writable_v<Stream>)
+				if (m_Writing && m_Block.size() != 0)
+					try
+					{
+						flush();
+					}
+					catch (...)
+					{
+					}
+		}
+
+		// Read-only over read-only streams
+		constexpr CompressedStream& write(char const* src, std::streamsize count) requires (detail::has_streambuf_v<Stream> || detail::is_writable_v<Stream>)
+		{
+			m_Writing = true;
+			while (count != 0)
+			{
+				std::streamsize const part = std::min(count, std::streamsize(SIZE - m_Block.size()));
+				m_Block.write(src, part);
+				src += part;
+				count -= part;
+
+				if (m_Block.size() == SIZE)
+					flush();
+			}
+
+			return *this;
+		}
+
+		constexpr CompressedStream& read(char* dest, std::streamsize count)
+		{
+			while (count != 0)
+			{
+				if (m_Block.size() == 0 && !next())
+				{
+					fail();
+					break;
+				}
+
+				std::streamsize const part = std::min(count, std::streamsize(m_Block.size()));
+				m_Block.read(dest, part);
+				dest += part;
+				count -= part;
+			}
+
+			return *this;
+		}
+
+		// Compress and write the written bytes as a block
+		constexpr void flush()
+		{
+			// Bytes read ahead are not written back
+			if (!m_Writing || m_Block.size() == 0)
+				return;
+
+			auto const raw = m_Block.queued();
+
+			m_Packed.resize(Codec::bound(raw.size()));
+			size_t const packed = Codec::compress(raw, m_Packed);
+
+			bool const stored = packed >= raw.size();
+			put_header(raw.size(), stored ? raw.size() : packed, stored ? 0 : Codec::id);
+			put(stored ? raw : std::span<std::byte const>{ m_Packed }.first(packed));
+
+			m_Block.clear();
+		}
+
+	private:
+
+		static constexpr size_t header_size = 9;
+
+		constexpr void put_header(size_t raw, size_t packed, uint8_t codec)
+		{
+			std::array<std::byte, header_size> header{};
+			for (size_t i = 0; i < 4; ++i)
+			{
+				header[i] = std::byte(raw >> (i * 8));
+				header[4 + i] = std::byte(packed >> (i * 8));
+			}
+			header[8] = std::byte{ codec };
+
+			put(header);
+		}
+
+		constexpr void put(std::span<std::byte const> bytes)
+		{
+			if (!detail::put_bytes(m_Stream, bytes))
+				fail();
+		}
+
+		// Read the next block into the Serializer buffer
+		constexpr bool next()
+		{
+			std::array<std::byte, header_size> header{};
+			if (!detail::get_bytes(m_Stream, header))
+				return false;
+
+			size_t raw{}, packed{};
+			for (size_t i = 0; i < 4; ++i)
+			{
+				raw |= size_t(header[i]) << (i * 8);
+				packed |= size_t(header[4 + i]) << (i * 8);
+			}
+			uint8_t const codec = uint8_t(header[8]);
+
+			if (raw > SIZE || (codec == 0 ? packed != raw : codec != Codec::id || packed >= raw))
+				detail::corrupt_block();
+
+			m_Block.clear();
+			auto const block = m_Block.prepare(raw).first(raw);
+
+			if (codec == 0)
+			{
+				if (!detail::get_bytes(m_Stream, block))
+					return false;
+			}
+			else
+			{
+				m_Packed.resize(packed);
+				if (!detail::get_bytes(m_Stream, m_Packed))
+					return false;
+
+				Codec::decompress(m_Packed, block);
+			}
+
+			m_Block.commit(raw);
+			return true;
+		}
+
+		constexpr void fail()
+		{
+			if constexpr (detail::has_streambuf_v<Stream>)
+				m_Stream.setstate(std::ios_base::failbit);
+			else
+				throw std::runtime_error{ "Compressed stream failed" };
+		}
+
+		Stream& m_Stream;
+
+		// Raw bytes of the current block
+		Serializer<> m_Block;
+
+		// Compressed bytes of the current block
+		std::vector<std::byte> m_Packed{};
+
+		// Written to, the block holds bytes to flush rather than bytes read ahead
+		bool m_Writing{};
+
+	};
+
+}
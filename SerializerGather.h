@@ -0,0 +1,298 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#include "ConstexprSerializerBuffer.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+namespace serializer_helper
+{
+
+	namespace detail
+	{
+		[[noreturn]] inline void throw_file_error(char const* message)
+		{
+			throw std::system_error{ errno, std::system_category(), message };
+		}
+
+		// Bytes from several places written or read in one call
+		// writev/readv on POSIX, one call per region otherwise
+		// Returns the bytes transferred, fewer than requested on a short read or write
+		inline size_t transfer_once(int file, std::span<std::span<std::byte> const> regions, bool write)
+		{
+#if defined(_WIN32)
+			size_t done{};
+			for (auto const region : regions)
+			{
+				int const count = write
+					? _write(file, region.data(), unsigned(region.size()))
+					: _read(file, region.data(), unsigned(region.size()));
+
+				if (count < 0)
+					throw_file_error(write ? "Writing file failed" : "Reading file failed");
+
+				done += size_t(count);
+				if (size_t(count) != region.size())
+					break;
+			}
+			return done;
+#else
+			std::array<iovec, 64> vectors;
+			size_t const count = std::min(regions.size(), vectors.size());
+			for (size_t i = 0; i < count; ++i)
+				vectors[i] = { regions[i].data(), regions[i].size() };
+
+			ssize_t done;
+			do
+				done = write ? ::writev(file, vectors.data(), int(count)) : ::readv(file, vectors.data(), int(count));
+			while (done < 0 && errno == EINTR);
+
+			if (done < 0)
+				throw_file_error(write ? "Writing file failed" : "Reading file failed");
+
+			return size_t(done);
+#endif
+		}
+
+		// Transfer at least minimum bytes of the regions, returns fewer only at the end of a file being read
+		inline size_t transfer(int file, std::span<std::span<std::byte>> regions, size_t minimum, bool write)
+		{
+			size_t total{};
+			while (total < minimum && !regions.empty())
+			{
+				size_t done = transfer_once(file, regions, write);
+				if (done == 0)
+				{
+					if (write)
+						throw std::runtime_error{ "Writing file failed" };
+					break;
+				}
+				total += done;
+
+				// Drop the regions done, and the part of the one done partially
+				while (!regions.empty() && done >= regions.front().size())
+				{
+					done -= regions.front().size();
+					regions = regions.subspan(1);
+				}
+				if (!regions.empty())
+					regions.front() = regions.front().subspan(done);
+			}
+			return total;
+		}
+	}
+
+	//
+	// Gathering writer to a file descriptor
+	// Writes are copied: small ones (headers, length prefixes, small values) into an arena of SIZE bytes,
+	// ones of at least THRESHOLD bytes are written with the arena in one writev before write() returns.
+	// write_referenced() of at least THRESHOLD bytes, which layouts use for contiguous containers of trivially
+	// copyable values, is not copied: the bytes are written with the arena in one writev on flush().
+	// Referenced objects must stay alive and unchanged until flush() or destruction.
+	// Throws std::system_error when writing fails, only flush() reports errors on destruction.
+	//
+	template <size_t SIZE = 64 * 1024, size_t THRESHOLD = 4 * 1024>
+	class GatherWriter
+	{
+
+		static_assert(THRESHOLD != 0 && THRESHOLD <= SIZE, "Writes below the threshold must fit the arena");
+
+	public:
+
+		explicit GatherWriter(int file)
+			: m_File{ file }
+			, m_Arena(SIZE)
+		{}
+
+		GatherWriter(GatherWriter const&) = delete;
+		GatherWriter& operator = (GatherWriter const&) = delete;
+
+		~GatherWriter()
+		{
+			try
+			{
+				flush();
+			}
+			catch (...)
+			{
+			}
+		}
+
+		GatherWriter& write(char const* src, std::streamsize count)
+		{
+			return write(std::span{ reinterpret_cast<std::byte const*>(src), size_t(count) });
+		}
+		//
+		GatherWriter& write(std::span<std::byte const> bytes)
+		{
+			if (bytes.empty())
+				return *this;
+
+			// The bytes may be reused once this returns
+			if (bytes.size() >= THRESHOLD)
+			{
+				add(bytes);
+				flush();
+				return *this;
+			}
+
+			if (bytes.size() > m_Arena.prepare(0).size())
+				flush();
+
+			// Extends the last region when it ends in the arena
+			auto const free = m_Arena.prepare(bytes.size());
+			std::memcpy(free.data(), bytes.data(), bytes.size());
+			m_Arena.commit(bytes.size());
+
+			if (!m_Regions.empty() && m_Regions.back().data() + m_Regions.back().size() == free.data())
+				m_Regions.back() = { m_Regions.back().data(), m_Regions.back().size() + bytes.size() };
+			else
+				add(free.first(bytes.size()));
+
+			return *this;
+		}
+
+		// Bytes that stay alive and unchanged until flush(), written without copying them when large
+		GatherWriter& write_referenced(std::span<std::byte const> bytes)
+		{
+			if (bytes.size() < THRESHOLD)
+				return write(bytes);
+
+			add(bytes);
+			return *this;
+		}
+
+		// Write the gathered regions
+		void flush()
+		{
+			try
+			{
+				if (!m_Regions.empty())
+					detail::transfer(m_File, m_Regions, size(), true);
+			}
+			catch (...)
+			{
+				// Copied bytes may be gone once the write throws
+				m_Regions.clear();
+				m_Arena.clear();
+				throw;
+			}
+
+			m_Regions.clear();
+			m_Arena.clear();
+		}
+
+		// Bytes gathered and not yet written
+		size_t size() const noexcept
+		{
+			size_t size{};
+			for (auto const region : m_Regions)
+				size += region.size();
+			return size;
+		}
+
+	private:
+
+		void add(std::span<std::byte const> bytes)
+		{
+			// Referenced bytes are only read, regions are mutable for readv
+			m_Regions.push_back({ const_cast<std::byte*>(bytes.data()), bytes.size() });
+		}
+
+		int m_File;
+
+		Serializer<> m_Arena;
+
+		std::vector<std::span<std::byte>> m_Regions{};
+
+	};
+
+	//
+	// Scattering reader from a file descriptor
+	// Small reads are served from a block of SIZE bytes read ahead.
+	// Reads of at least THRESHOLD bytes go straight into the destination with one readv,
+	// which reads the next block ahead in the same call.
+	// Throws std::system_error when reading fails, std::runtime_error when reading past the end of the file.
+	//
+	template <size_t SIZE = 64 * 1024, size_t THRESHOLD = 4 * 1024>
+	class ScatterReader
+	{
+	public:
+
+		explicit ScatterReader(int file)
+			: m_File{ file }
+			, m_Block(SIZE)
+		{}
+
+		ScatterReader(ScatterReader const&) = delete;
+		ScatterReader& operator = (ScatterReader const&) = delete;
+
+		ScatterReader& read(char* dest, std::streamsize count)
+		{
+			return read(std::span{ reinterpret_cast<std::byte*>(dest), size_t(count) });
+		}
+		//
+		ScatterReader& read(std::span<std::byte> dest)
+		{
+			// Read ahead bytes first
+			size_t const staged = std::min(dest.size(), m_End - m_Begin);
+			if (staged != 0)
+				std::memcpy(dest.data(), m_Block.data() + m_Begin, staged);
+			m_Begin += staged;
+			dest = dest.subspan(staged);
+
+			if (dest.empty())
+				return *this;
+
+			m_Begin = m_End = 0;
+
+			if (dest.size() >= THRESHOLD)
+			{
+				std::span<std::byte> regions[]{ dest, m_Block };
+				size_t const done = detail::transfer(m_File, regions, dest.size(), false);
+				if (done < dest.size())
+					throw std::runtime_error{ "Reading past the end of the file" };
+
+				m_End = done - dest.size();
+				return *this;
+			}
+
+			std::span<std::byte> regions[]{ m_Block };
+			m_End = detail::transfer(m_File, regions, dest.size(), false);
+			if (m_End < dest.size())
+				throw std::runtime_error{ "Reading past the end of the file" };
+
+			std::memcpy(dest.data(), m_Block.data(), dest.size());
+			m_Begin = dest.size();
+			return *this;
+		}
+
+	private:
+
+		int m_File;
+
+		std::vector<std::byte> m_Block;
+
+		// Read ahead bytes
+		size_t m_Begin{}, m_End{};
+
+	};
+
+}
@@ -0,0 +1,54 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerIndexed.h"
+
+#include <map>
+#include <set>
+
+using serializer_helper::Layout;
+using serializer_helper::Indexed;
+using serializer_helper::IndexedView;
+
+static_assert(
+	[]
+	{
+		Indexed<std::vector<std::string>> names{ "zero", "one", "two", "three" };
+
+		Serializer io(SerializerGrowth{});
+		Layout<Indexed<std::vector<std::string>>, int>::Write(io, names, 7);
+
+		// Random access, then the same bytes read whole
+		IndexedView<std::string> view{ io.view(io.size()) };
+		bool const random = view.size() == 4 && view.at(2) == "two" && view.at(0) == "zero" && view.at(3) == "three";
+
+		io.clear();
+		Layout<Indexed<std::vector<std::string>>, int>::Write(io, names, 7);
+		auto const [replica, after] = Layout<Indexed<std::vector<std::string>>, int>::Read(io);
+
+		return random && replica == names && after == 7;
+	}
+	(),
+	"Indexed vector"
+);
+
+static_assert(
+	[]
+	{
+		Indexed<std::vector<std::pair<int, std::string>>> sorted{ { 1, "a" }, { 3, "b" }, { 5, "c" }, { 8, "d" }, { 13, "e" } };
+
+		Serializer io(SerializerGrowth{});
+		Layout<decltype(sorted)>::Write(io, sorted);
+
+		// Searched by key
+		IndexedView<std::pair<int, std::string>> view{ io.view(io.size()) };
+		return view.lower_bound(4) == 2 && view.lower_bound(0) == 0 && view.lower_bound(14) == 5
+			&& view.find(8)->second == "d" && !view.find(7) && !view.find(20);
+	}
+	(),
+	"Searching an indexed sorted container"
+);
+
+// Indexed containers hash apart from plain ones
+static_assert(Layout<Indexed<std::set<std::string>>>::fingerprint() != Layout<std::set<std::string>>::fingerprint());
@@ -0,0 +1,238 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <functional>
+
+#include "SerializerIostreamHelper.h"
+
+namespace serializer_helper
+{
+
+	//
+	// Indexed container
+	// Written as: count, byte size of the elements, the elements, and the offset of every element (a vector<uint64_t>).
+	// Read back whole like the container, or element by element with an IndexedView.
+	//
+	template <typename Cont>
+	struct Indexed : Cont
+	{
+		using container_type = Cont;
+
+		using Cont::Cont;
+
+		constexpr Indexed() = default;
+
+		constexpr Indexed(Cont container)
+			: Cont(std::move(container))
+		{}
+	};
+
+	namespace detail
+	{
+
+		template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		bool parse_indexed(Stream& stream, Object& object)
+		{
+			using Cont = typename std::remove_cv_t<Object>::container_type;
+
+			if constexpr (W)
+			{
+				Cont const& cont = object;
+
+				std::vector<uint64_t> offsets;
+				offsets.reserve(std::size(cont));
+
+				uint64_t bytes{};
+				for (auto const& element : cont)
+				{
+					offsets.push_back(bytes);
+					bytes += encoded_size<Format>(element);
+				}
+
+				if (!parse_length<WRITE, Format>(stream, size_t(std::size(cont))) || !parse_object<WRITE, Format>(stream, std::as_const(bytes)))
+					return result_fail;
+
+				for (auto const& element : cont)
+					if (!parse_object<WRITE, Format>(stream, element))
+						return result_fail;
+
+				return parse_object<WRITE, Format>(stream, std::as_const(offsets));
+			}
+			else // R
+			{
+				Cont& cont = object;
+
+				size_t count{};
+				uint64_t bytes{};
+				if (!parse_length<READ, Format>(stream, count) || !parse_object<READ, Format>(stream, bytes))
+					return result_fail;
+
+				bool const decoded = Format::reuse
+					? reuse_elements<Format>(stream, cont, count)
+					: insert_elements<Format>(stream, cont, count);
+
+				if (!decoded)
+					return result_fail;
+
+				// The offsets are only used by IndexedView
+				return skip_values(stream, count, sizeof(uint64_t), length_size<Format>(count));
+			}
+		}
+
+	}
+
+	//
+	// Random access to an Indexed container without decoding it
+	// Reads the offset of an element and then the element only. Reading T must match the elements written,
+	// for example std::string_view elements of an indexed std::set<std::string> read from bytes without a copy.
+	// Over bytes (a buffer or mapped file) or a seekable stream (std::istream), which is read on access.
+	//
+	template <typename T, typename Format = DefaultFormat, typename Stream = detail::ByteReader>
+	class IndexedView
+	{
+
+		using Source = std::conditional_t<std::is_same_v<Stream, detail::ByteReader>, detail::ByteReader, Stream&>;
+
+	public:
+
+		// Over bytes starting with the indexed container
+		constexpr explicit IndexedView(std::span<std::byte const> bytes) requires std::is_same_v<Stream, detail::ByteReader>
+			: m_Stream{ bytes }
+		{
+			open();
+		}
+
+		// Over a stream positioned at the indexed container
+		constexpr explicit IndexedView(Stream& stream) requires (!std::is_same_v<Stream, detail::ByteReader>)
+			: m_Stream{ stream }
+		{
+			open();
+		}
+
+		// Element count
+		constexpr size_t size() const noexcept
+		{
+			return m_Size;
+		}
+
+		// Decode element index
+		constexpr T at(size_t index)
+		{
+			if (index >= m_Size)
+				throw std::out_of_range{ "Indexed element out of range" };
+
+			seek(m_Elements + offset(index));
+
+			T element{};
+			if (!detail::parse_object<detail::READ, Format>(m_Stream, element))
+				throw std::runtime_error{ "Read failed" };
+
+			return element;
+		}
+
+		// Index of the first element not ordered before key, the container must be written in order (sets, maps)
+		// Elements of maps are compared by their key
+		template <typename Key, typename Compare = std::less<>>
+		constexpr size_t lower_bound(Key const& key, Compare compare = {})
+		{
+			size_t first{}, count{ m_Size };
+			while (count != 0)
+			{
+				size_t const half = count / 2;
+				if (compare(key_of(at(first + half)), key))
+				{
+					first += half + 1;
+					count -= half + 1;
+				}
+				else
+					count = half;
+			}
+			return first;
+		}
+
+		// Element equivalent to key, if any, in log(size) element reads
+		template <typename Key, typename Compare = std::less<>>
+		constexpr std::optional<T> find(Key const& key, Compare compare = {})
+		{
+			size_t const index = lower_bound(key, compare);
+			if (index == m_Size)
+				return std::nullopt;
+
+			T element = at(index);
+			if (compare(key, key_of(element)))
+				return std::nullopt;
+
+			return element;
+		}
+
+	private:
+
+		static constexpr auto const& key_of(T const& element) noexcept
+		{
+			if constexpr (requires { element.first; element.second; })
+				return element.first;
+			else
+				return element;
+		}
+
+		constexpr uint64_t position()
+		{
+			return uint64_t(std::streamoff(m_Stream.tellg()));
+		}
+
+		constexpr void seek(uint64_t position)
+		{
+			if constexpr (std::is_same_v<Stream, detail::ByteReader>)
+				m_Stream.seekg(size_t(position));
+			else
+				m_Stream.seekg(typename Stream::pos_type(typename Stream::off_type(position)));
+		}
+
+		// Read the header and check the offset table
+		constexpr void open()
+		{
+			uint64_t bytes{};
+			if (!detail::parse_length<detail::READ, Format>(m_Stream, m_Size) || !detail::parse_object<detail::READ, Format>(m_Stream, bytes))
+				throw std::runtime_error{ "Read failed" };
+
+			m_Elements = position();
+
+			seek(m_Elements + bytes);
+
+			size_t count{};
+			if (!detail::parse_length<detail::READ, Format>(m_Stream, count) || count != m_Size)
+				throw std::runtime_error{ "Indexed offset table does not match its elements" };
+
+			m_Offsets = position();
+		}
+
+		constexpr uint64_t offset(size_t index)
+		{
+			seek(m_Offsets + index * sizeof(uint64_t));
+
+			uint64_t offset{};
+			detail::parse_object<detail::READ, Format>(m_Stream, offset);
+			return offset;
+		}
+
+		Source m_Stream;
+
+		size_t m_Size{};
+
+		// Positions of the first element and of the first offset
+		uint64_t m_Elements{}, m_Offsets{};
+
+	};
+
+}
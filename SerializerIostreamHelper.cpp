@@ -4,6 +4,8 @@
 #include "ConstexprSerializerBuffer.h"
 #include "SerializerIostreamHelper.h"
 
+#include <map>
+
 static_assert(
 	[]
 	{
@@ -68,3 +70,454 @@ static_assert(
 	(),
 	"Serializing a vector and wstring"
 );
+
+static_assert(
+	[]
+	{
+		using Fixed = Layout<int, double, std::array<short, 3>>;
+		using Dynamic = Layout<int, std::string, std::vector<std::wstring>>;
+
+		static_assert(Fixed::size == sizeof(int) + sizeof(double) + sizeof(short) * 3);
+		static_assert(Dynamic::size == serializer_helper::dynamic_size);
+
+		std::vector<std::wstring> const strings{ L"ab", L"", L"cde" };
+		size_t const size = Dynamic::size_of(7, "Hello", strings);
+
+		// Exact size
+		Serializer io(size);
+		Dynamic::Write(io, 7, "Hello", strings);
+
+		auto const [i, str, vec] = Dynamic::Read(io);
+
+		return size == sizeof(int) + (sizeof(size_t) + 5) + (sizeof(size_t) * 4 + sizeof(wchar_t) * 5)
+			&& Fixed::size_of(1, 2., {}) == Fixed::size
+			&& i == 7 && str == "Hello" && vec == strings;
+	}
+	(),
+	"Layout size"
+);
+
+static_assert(
+	[]
+	{
+		using MyLayout = Layout<std::vector<int>, std::string, int>;
+
+		// Reserves once
+		Serializer io(SerializerGrowth{});
+		MyLayout::Write(io, {}, "", 13);
+
+		auto const [vec, str, i] = MyLayout::Read(io);
+
+		return vec.empty() && str.empty() && i == 13
+			&& io.capacity() == MyLayout::size_of({}, "", 13);
+	}
+	(),
+	"Empty containers and reserving a layout"
+);
+
+static_assert(
+	[]
+	{
+		using MyLayout = Layout<std::span<std::byte const>, int>;
+
+		std::array<std::byte, 3> const bytes{ std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 } };
+
+		Serializer<64> io{};
+		MyLayout::Write(io, bytes, 7);
+
+		// Points into the buffer
+		auto const [view, i] = MyLayout::Read(io);
+
+		return std::ranges::equal(view, bytes) && i == 7;
+	}
+	(),
+	"Reading a view"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::BasicLayout;
+		using serializer_helper::VarintFormat;
+
+		using MyLayout = BasicLayout<VarintFormat, std::string, std::vector<std::string>>;
+
+		std::vector<std::string> const strings{ "a", "bc", std::string(200, 'd') };
+
+		Serializer io(MyLayout::size_of("Hi", strings));
+		MyLayout::Write(io, "Hi", strings);
+
+		auto const [str, vec] = MyLayout::Read(io);
+
+		// 1 byte prefixes below 128, 2 bytes below 16384
+		return MyLayout::size_of("Hi", strings) == (1 + 2) + (1 + (1 + 1) + (1 + 2) + (2 + 200))
+			&& str == "Hi" && vec == strings;
+	}
+	(),
+	"Varint length prefixes"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::BasicLayout;
+		using serializer_helper::VarintFormat;
+
+		using Length = BasicLayout<VarintFormat, std::span<std::byte const>>;
+
+		std::array<std::byte, 0> const empty{};
+
+		// Length prefixes of the boundaries between byte counts
+		for (uint64_t const count : { 0ull, 127ull, 128ull, 16383ull, 16384ull, (1ull << 56) - 1, 1ull << 56, ~0ull })
+		{
+			Serializer<16> io{};
+			serializer_helper::detail::write_varint(io, count);
+
+			uint64_t replica{};
+			if (!serializer_helper::detail::read_varint(io, replica) || replica != count)
+				return false;
+		}
+
+		Serializer<16> io{};
+		Length::Write(io, empty);
+		return Length::size_of(empty) == 1 && std::get<0>(Length::Read(io)).empty();
+	}
+	(),
+	"Varint boundaries"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::BasicLayout;
+		using serializer_helper::BigEndianFormat;
+		using serializer_helper::LittleEndianFormat;
+
+		using BigLayout = BasicLayout<BigEndianFormat, uint32_t, std::vector<uint16_t>>;
+		using LittleLayout = BasicLayout<LittleEndianFormat, uint32_t, std::vector<uint16_t>>;
+
+		Serializer<32> big{}, little{};
+		BigLayout::Write(big, 0x01020304, { 0x0506 });
+		LittleLayout::Write(little, 0x01020304, { 0x0506 });
+
+		// Same bytes on any host
+		auto const big_bytes = big.read<std::array<uint8_t, 4 + 8 + 2>>();
+		auto const little_bytes = little.read<std::array<uint8_t, 4 + 8 + 2>>();
+
+		BigLayout::Write(big, 0x01020304, { 0x0506 });
+		auto const [i, vec] = BigLayout::Read(big);
+
+		return big_bytes[0] == 0x01 && big_bytes[3] == 0x04
+			&& big_bytes[11] == 1 && big_bytes[12] == 0x05
+			&& little_bytes[0] == 0x04 && little_bytes[4] == 1 && little_bytes[12] == 0x06
+			&& i == 0x01020304 && vec.at(0) == 0x0506;
+	}
+	(),
+	"Endian stable formats"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::BufferedStream;
+
+		using MyLayout = Layout<int, std::string, std::vector<short>, char>;
+
+		Serializer<128> io{};
+
+		// Small block, batches the int and prefixes, bypasses with the string
+		{
+			BufferedStream<Serializer<128>, 16> buffered{ io };
+			MyLayout::Write(buffered, 13, "Hello buffered world", { 1, 2, 3 }, 'x');
+
+			// Nothing written before flushing
+			if (io.size() != sizeof(int) + sizeof(size_t) + 20)
+				return false;
+		}
+
+		BufferedStream<Serializer<128>, 16> buffered{ io };
+		auto const [i, str, vec, c] = MyLayout::Read(buffered);
+
+		return i == 13 && str == "Hello buffered world" && vec.size() == 3 && vec[2] == 3 && c == 'x';
+	}
+	(),
+	"Buffered stream"
+);
+
+static_assert(
+	[]
+	{
+		struct Point
+		{
+			int x, y;
+		};
+
+		struct Record
+		{
+			std::string name;
+			std::vector<Point> points;
+			Point origin;
+			short id;
+			std::pair<std::string, int> tag;
+		};
+
+		using MyLayout = Layout<Record, std::vector<Record>>;
+
+		Record record{ "first", { { 1, 2 }, { 3, 4 } }, { 5, 6 }, 7, { "tag", 8 } };
+		std::vector<Record> records{ record, Record{ "second", {}, {}, 0, {} } };
+
+		Serializer io(MyLayout::size_of(record, records));
+		MyLayout::Write(io, record, records);
+
+		auto const [replica, replicas] = MyLayout::Read(io);
+
+		return replica.name == "first" && replica.points[1].y == 4 && replica.origin.x == 5 && replica.id == 7
+			&& replica.tag.first == "tag" && replica.tag.second == 8
+			&& replicas.size() == 2 && replicas[1].name == "second" && replicas[1].points.empty();
+	}
+	(),
+	"Aggregate decomposition"
+);
+
+namespace
+{
+	// Aggregate with its own wire format, only its name
+	struct Named
+	{
+		std::string name;
+		int cached;
+
+		template <typename Stream>
+		friend constexpr bool write(Stream& os, Named const& named)
+		{
+			return Layout<std::string>::Write(os, named.name);
+		}
+
+		template <typename Stream>
+		friend constexpr bool read(Stream& is, Named& named)
+		{
+			named.cached = -1;
+			return Layout<std::string>::Read(is, named.name);
+		}
+	};
+}
+
+static_assert(
+	[]
+	{
+		Serializer io(SerializerGrowth{});
+		Layout<Named, std::vector<Named>>::Write(io, Named{ "one", 1 }, { Named{ "two", 2 } });
+
+		// Not decomposed, no field bytes for cached
+		size_t const size = io.size();
+		auto const [named, names] = Layout<Named, std::vector<Named>>::Read(io);
+
+		return size == 2 * (sizeof(size_t) + 3) + sizeof(size_t)
+			&& named.name == "one" && named.cached == -1 && names[0].name == "two" && names[0].cached == -1;
+	}
+	(),
+	"User defined read and write before decomposition"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::BasicLayout;
+		using serializer_helper::BigEndianFormat;
+
+		struct Padded
+		{
+			char c;
+			int i;
+		};
+
+		using MyLayout = BasicLayout<BigEndianFormat, Padded, std::vector<Padded>>;
+
+		// Decomposed to swap fields, without padding
+		static_assert(MyLayout::size == serializer_helper::dynamic_size);
+		static_assert(BasicLayout<BigEndianFormat, Padded>::size == 5);
+
+		Serializer<32> io{};
+		MyLayout::Write(io, { 'a', 0x01020304 }, { { 'b', 5 } });
+
+		auto const bytes = io.read<std::array<uint8_t, 5>>();
+		auto const [vec] = BasicLayout<BigEndianFormat, std::vector<Padded>>::Read(io);
+
+		return bytes[0] == 'a' && bytes[1] == 0x01 && bytes[4] == 0x04
+			&& vec.size() == 1 && vec[0].c == 'b' && vec[0].i == 5;
+	}
+	(),
+	"Swapping decomposed fields"
+);
+
+namespace
+{
+	// Allocator counting its allocations
+	template <typename T>
+	struct CountingAllocator
+	{
+		using value_type = T;
+
+		constexpr CountingAllocator(int* count)
+			: count{ count }
+		{}
+
+		template <typename U>
+		constexpr CountingAllocator(CountingAllocator<U> const& other)
+			: count{ other.count }
+		{}
+
+		constexpr T* allocate(size_t n)
+		{
+			++*count;
+			return std::allocator<T>{}.allocate(n);
+		}
+
+		constexpr void deallocate(T* pointer, size_t n)
+		{
+			std::allocator<T>{}.deallocate(pointer, n);
+		}
+
+		template <typename U>
+		constexpr bool operator == (CountingAllocator<U> const& other) const
+		{
+			return count == other.count;
+		}
+
+		int* count;
+	};
+}
+
+static_assert(
+	[]
+	{
+		int buffer{}, elements{};
+
+		using Ints = std::vector<int, CountingAllocator<int>>;
+		using Nested = std::vector<Ints, CountingAllocator<Ints>>;
+
+		Serializer<std::dynamic_extent, CountingAllocator<std::byte>> io(SerializerGrowth{}, &buffer);
+		Layout<std::vector<std::vector<int>>>::Write(io, { { 1, 2, 3 }, { 4 } });
+
+		// Inner vectors are constructed with the outer allocator
+		Nested replica(&elements);
+		serializer_helper::read(io, replica);
+
+		return buffer > 0 && elements >= 3
+			&& replica.size() == 2 && replica[0][2] == 3 && replica[1][0] == 4
+			&& replica[1].get_allocator().count == &elements;
+	}
+	(),
+	"Allocator aware buffer and containers"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::BasicLayout;
+		using serializer_helper::ReuseFormat;
+
+		using Strings = std::vector<std::string>;
+
+		Serializer io(SerializerGrowth{});
+		Layout<Strings, Strings>::Write(io, { "a", "bc" }, { "d" });
+
+		// Appends, reserving first
+		Strings strings{ "old" };
+		serializer_helper::read(io, strings);
+
+		// Replaces, reading into the existing strings
+		Strings reused{ "a string longer than the small string buffer", "x", "y" };
+		auto const capacity = reused[0].capacity();
+		BasicLayout<ReuseFormat, Strings>::Read(io, reused);
+
+		return strings.size() == 3 && strings[2] == "bc"
+			&& reused.size() == 1 && reused[0] == "d" && reused[0].capacity() == capacity;
+	}
+	(),
+	"Reading into existing containers"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::BasicLayout;
+		using serializer_helper::VarintFormat;
+
+		struct Point
+		{
+			int x, y;
+		};
+
+		struct Named
+		{
+			std::string name;
+			std::vector<Point> points;
+		};
+
+		// Sequences of the same elements hash alike, whatever their container
+		static_assert(Layout<std::string>::fingerprint() == Layout<std::string_view>::fingerprint());
+		static_assert(Layout<std::map<int, float>>::fingerprint() == Layout<std::vector<std::pair<int, float>>>::fingerprint());
+
+		// Kinds, sizes, nesting and formats differ
+		static_assert(Layout<int>::fingerprint() != Layout<float>::fingerprint());
+		static_assert(Layout<int>::fingerprint() != Layout<unsigned>::fingerprint());
+		static_assert(Layout<std::vector<int>>::fingerprint() != Layout<std::vector<short>>::fingerprint());
+		static_assert(Layout<std::vector<std::vector<int>>>::fingerprint() != Layout<std::vector<int>>::fingerprint());
+
+		// Types, not bytes: aggregates and arrays of the same fields write the same bytes and differ
+		static_assert(Layout<Point>::fingerprint() != Layout<std::array<int, 2>>::fingerprint());
+		static_assert(Layout<Named>::fingerprint() != Layout<std::string, std::vector<std::array<int, 2>>>::fingerprint());
+		static_assert(Layout<int, float>::fingerprint() != Layout<float, int>::fingerprint());
+		static_assert(Layout<std::string>::fingerprint() != BasicLayout<VarintFormat, std::string>::fingerprint());
+
+		Serializer<64> io{};
+		Layout<Named>::WriteHeader(io);
+		Layout<Named>::Write(io, Named{ "a", { { 1, 2 } } });
+		Layout<int>::WriteHeader(io);
+
+		bool const named = Layout<Named>::CheckHeader(io);
+		auto const [replica] = Layout<Named>::Read(io);
+
+		// Stale data is rejected before reading it
+		return named && replica.points[0].y == 2
+			&& !Layout<float>::CheckHeader(io);
+	}
+	(),
+	"Schema fingerprint"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::eFieldOffsets;
+
+		struct Header
+		{
+			std::string route;
+			int priority;
+		};
+
+		using Message = Layout<Header, std::vector<double>, std::vector<std::string>, std::string>;
+
+		Header header{ "orders", 3 };
+		std::vector<double> values(100, 1.5);
+		std::vector<std::string> tags{ "a", "b" };
+
+		Serializer io(SerializerGrowth{});
+		Message::Write(io, header, values, tags, "last");
+		Message::WriteWithOffsets(io, header, values, tags, "last");
+
+		// Found by skipping, then from the offset table
+		Message::View scanned{ io.queued() };
+		Message::View table{ io.queued().subspan(scanned.size()), eFieldOffsets::table };
+
+		return scanned.get<3>() == "last" && scanned.get<0>().route == "orders"
+			&& scanned.bytes<1>().size() == sizeof(size_t) + 100 * sizeof(double)
+			&& scanned.size() + table.size() == io.size()
+			&& table.get<3>() == "last" && table.get<2>()[1] == "b" && table.get<1>()[99] == 1.5
+			&& std::ranges::equal(scanned.bytes<2>(), table.bytes<2>());
+	}
+	(),
+	"Lazy layout view"
+);
@@ -5,21 +5,173 @@
 
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <array>
+#include <bit>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <cstring>
+#include <stdexcept>
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#include "SerializerByteOrder.h"
+#include "SerializerAggregate.h"
 
 namespace serializer_helper
 {
 
 	namespace detail
 	{
+		constexpr bool   READ = false;
+		constexpr bool   WRITE = true;
+
 		template <typename Object>
 		struct is_parsable;
 
 		template <typename Object, typename Return>
 		using enable_if_parsable_t = std::enable_if_t<is_parsable<Object>::value, Return>;
+
+		template <typename Object>
+		constexpr bool is_sizable() noexcept;
+
+		template <typename Format, typename ... Objects>
+		constexpr size_t fixed_size() noexcept;
+
+		template <typename Format, typename Object>
+		constexpr size_t size_of(Object const& object);
+
+		template <typename Format, typename ... Objects>
+		constexpr uint64_t fingerprint() noexcept;
+
+		template <typename Format, typename Object>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		uint64_t encoded_size(Object const& object);
+
+		template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		bool parse_object(Stream& stream, Object& object);
+
+		template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		bool parse_fields(Stream& stream, Object& object);
+
+		// Defined in SerializerIndexed.h
+		template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		bool parse_indexed(Stream& stream, Object& object);
+
+		// Defined in SerializerParallel.h
+		template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		bool parse_parallel(Stream& stream, Object& object);
+
+		// Defined in SerializerPacked.h
+		template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		bool parse_packed(Stream& stream, Object& object);
+
+		template <typename Stream, typename = void>
+		constexpr static bool is_preparable_v = false;
+
+		template <typename Stream, typename = void>
+		constexpr static bool is_reservable_v = false;
+
+		template <typename Stream, typename = void>
+		constexpr static bool has_streambuf_v = false;
+
+		template <typename Stream, typename = void>
+		constexpr static bool is_writable_v = false;
+
+		template <typename Stream, typename = void>
+		constexpr static bool writes_referenced_v = false;
 	}
 
+	//
+	// Container written with an offset table, see SerializerIndexed.h
+	//
+	template <typename Cont>
+	struct Indexed;
+
+	//
+	// Container written and read by several threads, see SerializerParallel.h
+	//
+	template <typename Cont, size_t CHUNK>
+	struct Parallel;
+
+	//
+	// Integer container written bit packed, see SerializerPacked.h
+	//
+	enum class ePacking;
+
+	template <typename Cont, ePacking PACKING>
+	struct Packed;
+
+	//
+	// Size of objects without a fixed size
+	//
+	inline constexpr size_t dynamic_size = size_t(-1);
+
+	//
+	// Formats
+	//
+
+	// Length prefixes as full size integers
+	struct FixedLength {};
+
+	// Length prefixes as prefix varints, 1 byte below 128 up to 9 bytes
+	// Trailing zeros of the first byte give the byte count, so the rest is read at once
+	struct VarintLength {};
+
+	// Wire format of a layout, derive from it to change options
+	struct DefaultFormat
+	{
+		using length = FixedLength;
+
+		// Byte order of values, swapped while parsing if it differs from the host's
+		// Trivially copyable objects without a byte order (structs) can only be parsed in the host's order
+		static constexpr std::endian endian = std::endian::native;
+
+		// Read containers into their existing elements instead of appending, reusing their capacity
+		static constexpr bool reuse = false;
+	};
+
+	struct VarintFormat : DefaultFormat
+	{
+		using length = VarintLength;
+	};
+
+	struct ReuseFormat : DefaultFormat
+	{
+		static constexpr bool reuse = true;
+	};
+
+	struct LittleEndianFormat : DefaultFormat
+	{
+		static constexpr std::endian endian = std::endian::little;
+	};
+
+	struct BigEndianFormat : DefaultFormat
+	{
+		static constexpr std::endian endian = std::endian::big;
+	};
+
 	//
 	// Read
 	//
@@ -38,19 +190,72 @@ namespace serializer_helper
 #endif
 	auto write(Stream& stream, Object const& object) -> detail::enable_if_parsable_t<Object, bool>;
 
+	// How a LayoutView finds its objects
+	enum class eFieldOffsets
+	{
+		// Skip over the objects once
+		scan,
+		// Read the table written by WriteWithOffsets
+		table
+	};
+
+	template <typename Format, typename ... Objects>
+	class LayoutView;
+
 	//
 	// Layout
 	//
-	template<typename ... Objects>
-	struct Layout
+	template<typename Format, typename ... Objects>
+	struct BasicLayout
 	{
+		// Lazy view of the objects in bytes, decoding them on access
+		using View = LayoutView<Format, Objects...>;
+
+		// Exact byte size when all objects are trivially copyable, otherwise dynamic_size
+		static constexpr size_t size = detail::fixed_size<Format, Objects...>();
+
+		// Byte size of the objects once written
+		static constexpr size_t size_of(Objects const& ... objects) requires (detail::is_sizable<Objects>() && ...)
+		{
+			return (size_t{} + ... + detail::size_of<Format>(objects));
+		}
+
+		// Hash of the format and of the kinds, sizes and nesting of the objects
+		// Types, not bytes: an aggregate and an array of the same fields write the same bytes and differ
+		static constexpr uint64_t fingerprint() noexcept
+		{
+			return detail::fingerprint<Format, Objects...>();
+		}
+
+		// Write the fingerprint, once in front of a stream or block of layouts
+		template <typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		static bool WriteHeader(Stream& os)
+		{
+			uint64_t const value{ fingerprint() };
+			return detail::parse_object<detail::WRITE, Format>(os, value);
+		}
+
+		// Read the fingerprint, false when written with another layout or format
+		template <typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		static bool CheckHeader(Stream& is)
+		{
+			uint64_t value{};
+			return detail::parse_object<detail::READ, Format>(is, value) && value == fingerprint();
+		}
+
 		template <typename Stream>
 #if defined(__cpp_lib_bit_cast)
 		constexpr
 #endif
 		static bool Read(Stream& is, Objects & ... objects)
 		{
-			return (read(is, objects) && ...);
+			return (detail::parse_object<detail::READ, Format>(is, objects) && ...);
 		}
 
 		template <typename Stream>
@@ -77,8 +282,180 @@ namespace serializer_helper
 #endif
 		static bool Write(Stream& os, Objects const& ... objects)
 		{
-			return (write(os, objects) && ...);
+			// Check capacity of (growing) buffers once for the whole layout
+			if constexpr ((detail::is_sizable<Objects>() && ...) && detail::is_preparable_v<Stream>)
+			{
+				if constexpr (size != dynamic_size)
+					os.prepare(size);
+				else if constexpr (detail::is_reservable_v<Stream>)
+					os.prepare(size_of(objects...));
+			}
+
+			return (detail::parse_object<detail::WRITE, Format>(os, objects) && ...);
+		}
+
+		// Write the offsets of the objects in front of them, for a View to find them without skipping
+		template <typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		static bool WriteWithOffsets(Stream& os, Objects const& ... objects)
+		{
+			// Relative to the end of the table, the last one is the end of the objects
+			std::array<uint64_t, sizeof...(Objects) + 1> offsets{};
+			size_t i{};
+			((offsets[i + 1] = offsets[i] + detail::encoded_size<Format>(objects), ++i), ...);
+
+			return detail::parse_object<detail::WRITE, Format>(os, std::as_const(offsets))
+				&& Write(os, objects...);
+		}
+	};
+
+	template<typename ... Objects>
+	using Layout = BasicLayout<DefaultFormat, Objects...>;
+
+	//
+	// Buffered stream
+	// Batches small reads and writes into blocks of SIZE bytes, large ones bypass the block.
+	// iostreams are accessed through sputn/sgetn on their rdbuf(), other streams through write/read.
+	// Use for reading or writing, not both. Written bytes are flushed on flush() and destruction,
+	// only flush() reports errors.
+	//
+	template <typename Stream, size_t SIZE = 64 * 1024>
+	class BufferedStream
+	{
+	public:
+
+		constexpr explicit BufferedStream(Stream& stream)
+			: m_Stream{ stream }
+		{}
+
+		BufferedStream(BufferedStream const&) = delete;
+		BufferedStream& operator = (BufferedStream const&) = delete;
+
+		constexpr ~BufferedStream()
+		{
+			if constexpr (detail::has_streambuf_v<Stream> || detail::is_writable_v<Stream>)
+				if (m_Put != 0)
+					try
+					{
+						flush();
+					}
+					catch (...)
+					{
+					}
+		}
+
+		constexpr BufferedStream& write(char const* src, std::streamsize count)
+		{
+			if (size_t(count) > SIZE - m_Put)
+			{
+				flush();
+
+				// Too large to batch
+				if (size_t(count) >= SIZE)
+				{
+					put(src, count);
+					return *this;
+				}
+			}
+
+			std::copy_n(src, count, std::data(m_Block) + m_Put);
+			m_Put += size_t(count);
+
+			return *this;
+		}
+
+		constexpr BufferedStream& read(char* dest, std::streamsize count)
+		{
+			// Staged bytes first
+			size_t const staged = std::min(size_t(count), m_End - m_Begin);
+			std::copy_n(std::data(m_Block) + m_Begin, staged, dest);
+			m_Begin += staged;
+
+			dest += staged;
+			count -= std::streamsize(staged);
+
+			if (count == 0)
+				return *this;
+
+			// Too large to batch
+			if (size_t(count) >= SIZE)
+			{
+				if (get(dest, count) != size_t(count))
+					fail();
+				return *this;
+			}
+
+			// Read ahead a block, may be short at the end of the stream
+			m_End = get(std::data(m_Block), SIZE, true);
+			m_Begin = std::min(size_t(count), m_End);
+			std::copy_n(std::data(m_Block), m_Begin, dest);
+
+			if (size_t(count) > m_End)
+				fail();
+
+			return *this;
+		}
+
+		// Write staged bytes to the stream
+		constexpr void flush()
+		{
+			if (m_Put != 0)
+				put(std::data(m_Block), std::streamsize(m_Put));
+
+			m_Put = 0;
+		}
+
+	private:
+
+		constexpr void put(char const* src, std::streamsize count)
+		{
+			if constexpr (detail::has_streambuf_v<Stream>)
+			{
+				if (m_Stream.rdbuf()->sputn(src, count) != count)
+					fail();
+			}
+			else
+				m_Stream.write(src, count);
+		}
+
+		constexpr size_t get(char* dest, std::streamsize count, bool ahead = false)
+		{
+			if constexpr (detail::has_streambuf_v<Stream>)
+			{
+				return size_t(m_Stream.rdbuf()->sgetn(dest, count));
+			}
+			else
+			{
+				// Read ahead what the stream holds
+				if constexpr (requires { m_Stream.size(); })
+					if (ahead)
+						count = std::min(count, std::streamsize(m_Stream.size()));
+
+				m_Stream.read(dest, count);
+				return size_t(count);
+			}
+		}
+
+		constexpr void fail()
+		{
+			if constexpr (detail::has_streambuf_v<Stream>)
+				m_Stream.setstate(std::ios_base::failbit);
+			else
+				throw std::runtime_error{ "Buffered stream failed" };
 		}
+
+		Stream& m_Stream;
+
+		std::array<char, SIZE> m_Block{};
+
+		// Staged bytes to write
+		size_t m_Put{};
+
+		// Staged bytes to read
+		size_t m_Begin{}, m_End{};
+
 	};
 
 
@@ -100,27 +477,108 @@ namespace detail
 		return bool(stream.rdstate() & state);
 	}
 
-	constexpr bool   READ = false;
-	constexpr bool   WRITE = true;
-
 	enum class eKind
 	{
 		invalid = 0,
 		trivial,
 		itterable,
-		pointer
+		pointer,
+		view,
+		aggregate,
+		indexed,
+		parallel,
+		packed
 	};
 
+	template <typename>
+	constexpr static bool is_indexed_v = false;
+
+	template <typename Cont>
+	constexpr static bool is_indexed_v<Indexed<Cont>> = true;
+
+	template <typename>
+	constexpr static bool is_parallel_v = false;
+
+	template <typename Cont, size_t CHUNK>
+	constexpr static bool is_parallel_v<Parallel<Cont, CHUNK>> = true;
+
+	template <typename>
+	constexpr static bool is_packed_v = false;
+
+	template <typename Cont, ePacking PACKING>
+	constexpr static bool is_packed_v<Packed<Cont, PACKING>> = true;
+
+	// Non-owning contiguous views, written as containers and read without copying
+	template <typename>
+	constexpr static bool is_view_v = false;
+
+	template <typename Char, typename Traits>
+	constexpr static bool is_view_v<std::basic_string_view<Char, Traits>> = true;
+
+#if defined(__cpp_lib_span)
+	template <typename T>
+	constexpr static bool is_view_v<std::span<T const>> = true;
+#endif
+
+	template <typename Stream, typename = void>
+	constexpr static bool is_viewable_v = false;
+
+	template <typename Stream>
+	constexpr static bool has_streambuf_v<Stream, std::void_t<decltype(std::declval<Stream&>().rdbuf()->sgetn(nullptr, 0))>> = true;
+
+	// Read-only streams have no write
+	template <typename Stream>
+	constexpr static bool is_writable_v<Stream, std::void_t<decltype(std::declval<Stream&>().write(std::declval<char const*>(), std::streamsize{}))>> = true;
+
+	// Streams that can keep a reference to bytes that stay alive until they are flushed, like GatherWriter
+	template <typename Stream>
+	constexpr static bool writes_referenced_v<Stream, std::void_t<decltype(std::declval<Stream&>().write_referenced(std::span<std::byte const>{}))>> = true;
+
 	template <typename, typename = void>
 	constexpr static bool is_iterable_v = false;
 
 	template <typename, typename = void>
 	constexpr static bool is_contiguous_container_v = false;
 
+	// User defined read/write of an object, for any stream they take
+	namespace user_parse
+	{
+		struct any_stream
+		{
+			template <typename Stream>
+			operator Stream& () const noexcept;
+		};
+
+		// Found instead of the library's read/write, and loses to any other match
+		void read(...) = delete;
+		void write(...) = delete;
+
+		template <typename Object>
+		constexpr bool has_user_parse_v =
+			requires (any_stream& stream, Object& object) { read(stream, object); }
+			|| requires (any_stream& stream, Object const& object) { write(stream, object); };
+	}
+
 	template <typename Object>
 	constexpr auto parse_kind() noexcept
 	{
-		if constexpr (std::is_trivially_copyable_v<Object>)
+		if constexpr (is_indexed_v<std::remove_cv_t<Object>>)
+		{
+			return eKind::indexed;
+		}
+		else if constexpr (is_parallel_v<std::remove_cv_t<Object>>)
+		{
+			return eKind::parallel;
+		}
+		else if constexpr (is_packed_v<std::remove_cv_t<Object>>)
+		{
+			return eKind::packed;
+		}
+		else if constexpr (is_view_v<std::remove_cv_t<Object>>)
+		{
+			return eKind::view;
+		}
+		else if constexpr (std::is_trivially_copyable_v<Object>)
 		{
 			return eKind::trivial;
 		}
@@ -132,6 +590,11 @@ namespace detail
 		{
 			return eKind::pointer;
 		}
+		// User defined read/write take precedence over decomposition
+		else if constexpr (is_tuple_like_v<std::remove_cv_t<Object>> || (is_decomposable_v<Object> && !user_parse::has_user_parse_v<std::remove_cv_t<Object>>))
+		{
+			return eKind::aggregate;
+		}
 		else return eKind::invalid;
 	}
 
@@ -176,49 +639,197 @@ namespace detail
 
 	}
 
-	// Array
+	// Values in a format's byte order
 
-	template <bool W, typename Pod, typename Stream>
+	template <typename Format>
+	constexpr bool is_swapped_v = Format::endian != std::endian::native;
+
+	template <bool W, typename Format, typename Pod, typename Stream>
 #if defined(__cpp_lib_bit_cast)
 	constexpr
 #endif
-	bool parse_array(Stream& stream, Pod* const data, ptrdiff_t const count)
+	bool parse_value(Stream& stream, Pod&& data)
 	{
-		if (count < 0)
-			return result_fail;
+		using Value = std::remove_cvref_t<Pod>;
+
+		if constexpr (!is_swapped_v<Format>)
+		{
+			return parse_pod<W>(stream, data);
+		}
+		else if constexpr (!has_byte_order_v<Value>)
+		{
+			static_assert(is_decomposable_v<Value>, "Object has no byte order, parse its members instead");
+
+			return parse_fields<W, Format>(stream, data);
+		}
 		else
-			if (count == 0)
+		{
+			if constexpr (W)
+			{
+				return parse_pod<WRITE>(stream, byteswap(Value{ data }));
+			}
+			else // R
+			{
+				if (!parse_pod<READ>(stream, data))
+					return result_fail;
+
+				data = byteswap(Value{ data });
 				return result_success;
-			else
-				if constexpr (W)
-				{
-					if (!parse_pod<WRITE>(stream, std::make_unsigned_t<ptrdiff_t>(count)))
-						return result_fail;
+			}
+		}
+	}
+
+	// Length prefix
+
+	constexpr size_t varint_size(uint64_t const value) noexcept
+	{
+		// 7 bits per byte, above 56 bits the first byte holds no value bits
+		return std::clamp<size_t>((size_t(std::bit_width(value)) + 6) / 7, 1, 9);
+	}
+
+	template <typename Stream>
 #if defined(__cpp_lib_bit_cast)
-					for (ptrdiff_t i = 0; i < count; ++i)
-						parse_pod<WRITE>(stream, data[i]);
-#else
-					// Undefined behaviour!!!
-					stream.write((char const* const)(data), count * sizeof(Pod));
+	constexpr
 #endif
-				}
-				else // R
-				{
+	bool write_varint(Stream& stream, uint64_t const value)
+	{
+		std::array<char, 9> buffer{};
+
+		// Value shifted after (bytes - 1) zero bits and a marker bit, 9 bytes start with a zero byte
+		size_t const bytes = varint_size(value);
+		size_t const offset = bytes / 9;
+		uint64_t const encoded = bytes < 9
+			? (value << bytes) | (uint64_t{ 1 } << (bytes - 1))
+			: value;
+
+		for (size_t i = 0; i < 8; ++i)
+			buffer[offset + i] = char(uint8_t(encoded >> (8 * i)));
+
+		stream.write(std::data(buffer), std::streamsize(bytes));
+		return result_success;
+	}
+
+	template <typename Stream, typename Size>
 #if defined(__cpp_lib_bit_cast)
-					for (ptrdiff_t i = 0; i < count; ++i)
-						parse_pod<READ>(stream, data[i]);
-#else
-					// Undefined behaviour!!!
-					stream.read((char* const)(data), count * sizeof(Pod));
+	constexpr
 #endif
-				}
+	bool read_varint(Stream& stream, Size& count)
+	{
+		std::array<char, 9> buffer{};
 
-#if defined(__cpp_lib_bit_cast)
-		if (std::is_constant_evaluated())
-			return result_success; // todo: fix?
+		// First byte gives the byte count, read the rest at once
+		stream.read(std::data(buffer), 1);
+		uint64_t const first = uint8_t(buffer[0]);
+		size_t const bytes = size_t(std::countr_zero(first | 0x100)) + 1;
+		stream.read(std::data(buffer) + 1, std::streamsize(bytes - 1));
+
+		uint64_t rest{};
+		for (size_t i = 0; i < 8; ++i)
+			rest |= uint64_t(uint8_t(buffer[i + 1])) << (8 * i);
+
+		uint64_t const value = bytes < 9
+			? ((rest << 8) | first) >> bytes
+			: rest;
+
+		if (value > uint64_t(std::numeric_limits<Size>::max()))
+			return result_fail;
+
+		count = Size(value);
+		return result_success;
+	}
+
+	template <bool W, typename Format, typename Size, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool parse_length(Stream& stream, Size&& count)
+	{
+		if constexpr (std::is_same_v<typename Format::length, VarintLength>)
+		{
+			if constexpr (W)
+				return write_varint(stream, uint64_t(count));
+			else // R
+				return read_varint(stream, count);
+		}
+		else
+		{
+			return parse_value<W, Format>(stream, count);
+		}
+	}
+
+	template <typename Format, typename Size>
+	constexpr size_t length_size(Size const count) noexcept
+	{
+		if constexpr (std::is_same_v<typename Format::length, VarintLength>)
+			return varint_size(uint64_t(count));
 		else
+			return sizeof(Size);
+	}
+
+	// Array
+
+	template <bool W, typename Format, typename Pod, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
 #endif
-			return /*failed(stream)
+	bool parse_array(Stream& stream, Pod* const data, ptrdiff_t const count)
+	{
+		if (count < 0)
+			return result_fail;
+
+		// Count is written even when empty, reading always expects it
+		if constexpr (W)
+			if (!parse_length<WRITE, Format>(stream, std::make_unsigned_t<ptrdiff_t>(count)))
+				return result_fail;
+
+		if (count == 0)
+			return result_success;
+
+		// Swapped in bulk, through a staging block when writing
+		if constexpr (is_swapped_v<Format> && has_byte_order_v<Pod>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				if constexpr (W)
+				{
+					using Value = std::remove_const_t<Pod>;
+					std::array<Value, std::max<size_t>(1, 4096 / sizeof(Value))> staging;
+
+					for (ptrdiff_t i = 0; i < count; i += std::ssize(staging))
+					{
+						auto const block = std::span{ staging }.first(size_t(std::min(count - i, std::ssize(staging))));
+						std::copy_n(data + i, block.size(), block.begin());
+						byteswap(block);
+						stream.write(reinterpret_cast<char const*>(block.data()), std::streamsize(block.size_bytes()));
+					}
+				}
+				else // R
+				{
+					stream.read(reinterpret_cast<char*>(data), std::streamsize(count * sizeof(Pod)));
+					byteswap(std::span{ data, size_t(count) });
+				}
+				return result_success;
+			}
+		}
+
+		// Element wise during constant evaluation, or decomposed to swap fields
+		if (std::is_constant_evaluated() || (is_swapped_v<Format> && !has_byte_order_v<Pod>))
+		{
+			for (ptrdiff_t i = 0; i < count; ++i)
+				parse_value<W, Format>(stream, data[i]);
+
+			return result_success; // todo: fix?
+		}
+
+		// Otherwise in one call, referencing the objects in place where the stream can
+		if constexpr (W && writes_referenced_v<Stream>)
+			stream.write_referenced(std::as_bytes(std::span{ data, size_t(count) }));
+		else if constexpr (W)
+			stream.write(reinterpret_cast<char const*>(data), std::streamsize(count * sizeof(Pod)));
+		else // R
+			stream.read(reinterpret_cast<char*>(data), std::streamsize(count * sizeof(Pod)));
+
+		return /*failed(stream)
 			? result_fail
 			:*/ result_success;
 	}
@@ -231,7 +842,173 @@ namespace detail
 	template <typename Cont>
 	constexpr static bool is_contiguous_container_v<Cont, std::void_t<decltype(std::data(std::declval<Cont&>()))>> = is_iterable_v<Cont>;
 
-	template <bool W, typename Cont, typename Stream>
+	// Element type to read into, map keys are const
+	template <typename T>
+	struct value
+	{
+		using type = T;
+	};
+
+	template <typename Key, typename T>
+	struct value<std::pair<Key const, T>>
+	{
+		using type = std::pair<Key, T>;
+	};
+
+	template <typename T>
+	using value_t = typename value<T>::type;
+
+	// Elements of allocator aware containers are constructed with the container's allocator, so nested std::pmr containers share the resource
+	template <typename T, typename Cont>
+	constexpr T make_element(Cont const& cont)
+	{
+		if constexpr (requires { cont.get_allocator(); })
+			return std::make_obj_using_allocator<T>(cont.get_allocator());
+		else
+			return T{};
+	}
+
+	// Elements to make room for up front, of a count read from the stream
+	// Every element takes a byte at least, so a corrupt count does not allocate more than the bytes a buffer holds,
+	// or than 64K elements for streams of unknown size. Containers grow past that as elements are read.
+	template <typename Stream>
+	constexpr size_t reserve_count(Stream& stream, size_t count) noexcept
+	{
+		if constexpr (is_viewable_v<Stream> && requires { stream.size(); })
+			return std::min(count, size_t(stream.size()));
+		else
+			return std::min<size_t>(count, 64 * 1024);
+	}
+
+	// Append count elements, reserving room for them first
+	template <typename Format, typename Cont, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool insert_elements(Stream& stream, Cont& cont, size_t count)
+	{
+		using T = std::decay_t<decltype(*begin(cont))>;
+
+		if (count == 0)
+			return result_success;
+
+		if constexpr (requires { cont.reserve(count); })
+			cont.reserve(size(cont) + reserve_count(stream, count));
+
+		auto inserter = std::inserter(cont, end(cont));
+		do
+		{
+			auto object = make_element<value_t<T>>(cont);
+			if (!parse_object<READ, Format>(stream, object))
+				return result_fail;
+			inserter = std::move(object);
+		} while (--count);
+
+		return result_success;
+	}
+
+	// Read into the value of an extracted node
+	template <typename Format, typename Node, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool parse_node(Stream& stream, Node& node)
+	{
+		if constexpr (requires { node.mapped(); })
+		{
+			using Pair = std::pair<typename Node::key_type, typename Node::mapped_type>;
+
+			// Pairs parsed field by field can be read into the node as is
+			if constexpr (parse_kind<Pair>() == eKind::aggregate)
+				return parse_object<READ, Format>(stream, node.key())
+					&& parse_object<READ, Format>(stream, node.mapped());
+			else
+			{
+				Pair pair{};
+				if (!parse_object<READ, Format>(stream, pair))
+					return result_fail;
+
+				node.key() = std::move(pair.first);
+				node.mapped() = std::move(pair.second);
+				return result_success;
+			}
+		}
+		else
+			return parse_object<READ, Format>(stream, node.value());
+	}
+
+	// Replace the contents with count elements, reading into the existing ones to keep their capacity
+	// Sequences are resized, nodes of associative containers are extracted and refilled
+	template <typename Format, typename Cont, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool reuse_elements(Stream& stream, Cont& cont, size_t count)
+	{
+		if constexpr (requires { cont.resize(count); })
+		{
+			// Grown up to what the stream can hold, the rest is appended
+			size_t const reused = std::min(count, std::max(size_t(size(cont)), reserve_count(stream, count)));
+			cont.resize(reused);
+			for (auto& element : cont)
+				if (!parse_object<READ, Format>(stream, element))
+					return result_fail;
+
+			return insert_elements<Format>(stream, cont, count - reused);
+		}
+		else if constexpr (requires { cont.extract(cont.begin()); })
+		{
+			Cont old(cont.get_allocator());
+			old.swap(cont);
+
+			if constexpr (requires { cont.reserve(count); })
+				cont.reserve(reserve_count(stream, count));
+
+			for (; count != 0 && !old.empty(); --count)
+			{
+				auto node = old.extract(old.begin());
+				if (!parse_node<Format>(stream, node))
+					return result_fail;
+				cont.insert(std::move(node));
+			}
+
+			return insert_elements<Format>(stream, cont, count);
+		}
+		else
+		{
+			cont.clear();
+			return insert_elements<Format>(stream, cont, count);
+		}
+	}
+
+	// Replace the contents of a contiguous container with count trivially copyable values
+	// Resized up to what the stream can hold, then grown in parts as the values arrive,
+	// so a corrupt count fails at the end of the stream before all of it is allocated
+	template <typename Format, typename Cont, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool read_values(Stream& stream, Cont& cont, size_t count)
+	{
+		size_t done{};
+		do
+		{
+			// A value at least, a stream holding none fails to read it
+			size_t const part = std::min(count - done, std::max({ done, reserve_count(stream, count), size_t{ 1 } }));
+			cont.resize(done + part);
+			if (!parse_array<READ, Format>(stream, data(cont) + done, ptrdiff_t(part)))
+				return result_fail;
+			done += part;
+
+			if constexpr (has_streambuf_v<Stream>)
+				if (failed(stream))
+					return result_fail;
+		} while (done != count);
+
+		return result_success;
+	}
+
+	template <bool W, typename Format, typename Cont, typename Stream>
 #if defined(__cpp_lib_bit_cast)
 	constexpr
 #endif
@@ -242,53 +1019,631 @@ namespace detail
 		{
 			if constexpr (W)
 			{
-				return parse_array<WRITE>(stream, data(cont), size(cont));
+				return parse_array<WRITE, Format>(stream, data(cont), size(cont));
 			}
 			else // R
 			{
 				decltype(size(cont)) count{};
-				if (!parse_pod<READ>(stream, count))
+				if (!parse_length<READ, Format>(stream, count))
 					return result_fail;
 
-				cont.resize(count);
-				return parse_array<READ>(stream, data(cont), count);
+				return read_values<Format>(stream, cont, count);
 			}
 		}
 		else
 		{
 			if constexpr (W)
 			{
-				parse_pod<WRITE>(stream, size(cont));
+				parse_length<WRITE, Format>(stream, size(cont));
 				for (auto const& el : cont)
-					if (!write(stream, el))
+					if (!parse_object<WRITE, Format>(stream, el))
 						return result_fail;
 				return result_success;
 			}
 			else // R
 			{
 				decltype(size(cont)) count{};
-				if (!parse_pod<READ>(stream, count))
+				if (!parse_length<READ, Format>(stream, count))
 					return result_fail;
-				if (count == 0)
+
+				if constexpr (Format::reuse)
+					return reuse_elements<Format>(stream, cont, count);
+				else
+					return insert_elements<Format>(stream, cont, count);
+			}
+		}
+	}
+
+	// Views
+
+	template <typename Stream>
+	constexpr static bool is_viewable_v<Stream, std::void_t<decltype(std::declval<Stream&>().view(size_t{}))>> = true;
+
+	template <bool W, typename Format, typename View, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool parse_view(Stream& stream, View& view)
+	{
+		using T = std::remove_const_t<typename View::value_type>;
+		if constexpr (W)
+		{
+			return parse_array<WRITE, Format>(stream, std::data(view), std::size(view));
+		}
+		else // R
+		{
+			static_assert(is_viewable_v<Stream>, "Views can only be read from a buffer");
+			// Swapped values would have to be swapped in the buffer
+			static_assert(!is_swapped_v<Format> || sizeof(T) == 1, "Views of multi byte values can not be read in a swapped byte order, read them into a container");
+
+			std::make_unsigned_t<ptrdiff_t> count{};
+			if (!parse_length<READ, Format>(stream, count))
+				return result_fail;
+
+			if constexpr (std::is_same_v<T, std::byte>)
+			{
+				view = View{ stream.view(size_t(count)) };
+			}
+			else
+			{
+				auto const values = stream.template view<T>(size_t(count));
+				view = View{ std::data(values), std::size(values) };
+			}
+			return result_success;
+		}
+	}
+
+	// Aggregates
+
+	template <typename Object>
+	constexpr auto tie_aggregate(Object& object) noexcept
+	{
+		if constexpr (is_tuple_like_v<std::remove_cv_t<Object>>)
+			return std::apply([](auto& ... fields) { return std::tie(fields...); }, object);
+		else
+			return tie_fields(object);
+	}
+
+	template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool parse_fields(Stream& stream, Object& object)
+	{
+		using Bytes = std::conditional_t<W, char const*, char*>;
+
+		// Run of trivially copyable fields adjacent in memory, parsed in one call
+		Bytes run{};
+		size_t run_size{};
+
+		auto const parse_run = [&]
+		{
+			if (run_size != 0)
+			{
+				if constexpr (W)
+					stream.write(run, std::streamsize(run_size));
+				else // R
+					stream.read(run, std::streamsize(run_size));
+			}
+			run_size = 0;
+		};
+
+		auto const parse_field = [&](auto& field) -> bool
+		{
+			using Field = std::remove_cvref_t<decltype(field)>;
+
+			if constexpr (parse_kind<Field>() == eKind::trivial && !is_swapped_v<Format>)
+				if (!std::is_constant_evaluated())
+				{
+					auto const bytes = reinterpret_cast<Bytes>(std::addressof(field));
+					if (run_size == 0 || run + run_size != bytes)
+					{
+						parse_run();
+						run = bytes;
+					}
+					run_size += sizeof(Field);
 					return result_success;
+				}
 
-				auto inserter = std::inserter(cont, end(cont));
-				do
+			parse_run();
+			return parse_object<W, Format>(stream, field);
+		};
+
+		bool const result = std::apply(
+			[&](auto& ... fields)
+			{
+				return (parse_field(fields) && ...);
+			},
+			tie_aggregate(object)
+		);
+
+		parse_run();
+		return result;
+	}
+
+	// Size
+
+	template <typename Cont>
+	using element_t = std::decay_t<decltype(*std::begin(std::declval<Cont&>()))>;
+
+	template <typename Object>
+	using aggregate_t = decltype(tie_aggregate(std::declval<Object&>()));
+
+	template <typename Object>
+	constexpr bool is_sizable() noexcept
+	{
+		if constexpr (constexpr auto kind = parse_kind<Object>(); kind == eKind::trivial || kind == eKind::view)
+			return true;
+		else if constexpr (kind == eKind::itterable)
+			return is_sizable<element_t<Object>>();
+		else if constexpr (kind == eKind::aggregate)
+			return []<typename ... Fields>(std::tuple<Fields...>*)
+			{
+				return (is_sizable<std::remove_cvref_t<Fields>>() && ...);
+			}
+			(static_cast<aggregate_t<Object>*>(nullptr));
+		else
+			return false;
+	}
+
+	// Size of a trivially copyable value, without padding when decomposed to swap its fields
+	template <typename Format, typename Value>
+	constexpr size_t value_size() noexcept
+	{
+		if constexpr (is_swapped_v<Format> && !has_byte_order_v<Value>)
+			return []<typename ... Fields>(std::tuple<Fields...>*)
+			{
+				return (size_t{} + ... + value_size<Format, std::remove_cvref_t<Fields>>());
+			}
+			(static_cast<aggregate_t<Value>*>(nullptr));
+		else
+			return sizeof(Value);
+	}
+
+	template <typename Format, typename ... Objects>
+	constexpr size_t fixed_size() noexcept
+	{
+		if constexpr (((parse_kind<Objects>() == eKind::trivial) && ...))
+			return (size_t{} + ... + value_size<Format, Objects>());
+		else
+			return dynamic_size;
+	}
+
+	template <typename Format, typename Object>
+	constexpr size_t size_of(Object const& object)
+	{
+		static_assert(is_sizable<Object>(), "Object size is unknown");
+
+		if constexpr (constexpr auto kind = parse_kind<Object>(); kind == eKind::trivial)
+		{
+			return value_size<Format, Object>();
+		}
+		else if constexpr (kind == eKind::aggregate)
+		{
+			return std::apply(
+				[](auto const& ... fields)
 				{
-					T object{};
-					if (!read(stream, object))
-						return result_fail;
-					inserter = std::move(object);
-				} while (--count);
+					return (size_t{} + ... + size_of<Format>(fields));
+				},
+				tie_aggregate(object)
+			);
+		}
+		else
+		{
+			using T = element_t<Object>;
+			if constexpr ((std::is_trivially_copyable_v<T> && is_contiguous_container_v<Object>) || parse_kind<Object>() == eKind::view)
+			{
+				auto const count = std::make_unsigned_t<ptrdiff_t>(std::size(object));
+				return length_size<Format>(count) + count * value_size<Format, T>();
+			}
+			else
+			{
+				size_t size{ length_size<Format>(std::size(object)) };
+				for (auto const& el : object)
+					size += size_of<Format>(el);
+				return size;
+			}
+		}
+	}
+
+	// Schema
+
+	// FNV-1a over the bytes of a value, in little endian order
+	constexpr uint64_t fnv1a(uint64_t hash, uint64_t value) noexcept
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			hash ^= (value >> (i * 8)) & 0xFF;
+			hash *= 0x100000001B3;
+		}
+		return hash;
+	}
+
+	// Nodes of a schema, sequences hash by their elements only (std::string and std::string_view alike)
+	// Aggregates, arrays and values are nodes of their own, even where their bytes match
+	enum class eSchema : uint64_t
+	{
+		custom,
+		boolean,
+		character,
+		integer,
+		unsigned_integer,
+		floating,
+		enumeration,
+		bytes,
+		array,
+		structure,
+		sequence,
+		fields,
+		indexed,
+		parallel,
+		packed,
+	};
+
+	template <typename Format, typename Object>
+	constexpr uint64_t schema_hash(uint64_t hash) noexcept;
+
+	template <typename Format, typename ... Fields>
+	constexpr uint64_t fields_hash(uint64_t hash, std::tuple<Fields...>*) noexcept
+	{
+		hash = fnv1a(hash, sizeof...(Fields));
+		((hash = schema_hash<Format, std::remove_cvref_t<Fields>>(hash)), ...);
+		return hash;
+	}
+
+	template <typename Format, typename Object>
+	constexpr uint64_t schema_hash(uint64_t hash) noexcept
+	{
+		using Value = std::remove_cv_t<Object>;
+
+		auto const node = [&hash](eSchema schema, uint64_t size)
+		{
+			hash = fnv1a(fnv1a(hash, uint64_t(schema)), size);
+		};
+
+		if constexpr (constexpr auto kind = parse_kind<Value>(); kind == eKind::trivial)
+		{
+			if constexpr (std::is_same_v<Value, bool>)
+				node(eSchema::boolean, sizeof(Value));
+			else if constexpr (std::is_same_v<Value, char> || std::is_same_v<Value, wchar_t> || std::is_same_v<Value, char8_t> || std::is_same_v<Value, char16_t> || std::is_same_v<Value, char32_t>)
+				node(eSchema::character, sizeof(Value));
+			else if constexpr (std::is_floating_point_v<Value>)
+				node(eSchema::floating, sizeof(Value));
+			else if constexpr (std::is_enum_v<Value>)
+				node(eSchema::enumeration, sizeof(Value));
+			else if constexpr (std::is_integral_v<Value>)
+				node(std::is_signed_v<Value> ? eSchema::integer : eSchema::unsigned_integer, sizeof(Value));
+			else if constexpr (is_std_array_v<Value>)
+			{
+				node(eSchema::array, std::tuple_size_v<Value>);
+				hash = schema_hash<Format, typename Value::value_type>(hash);
+			}
+			else if constexpr (is_decomposable_v<Value>)
+			{
+				node(eSchema::structure, sizeof(Value));
+				hash = fields_hash<Format>(hash, static_cast<aggregate_t<Value>*>(nullptr));
+			}
+			else
+				node(eSchema::bytes, sizeof(Value));
+		}
+		else if constexpr (kind == eKind::itterable || kind == eKind::view || kind == eKind::indexed || kind == eKind::parallel)
+		{
+			node(kind == eKind::indexed ? eSchema::indexed : kind == eKind::parallel ? eSchema::parallel : eSchema::sequence, 0);
+			hash = schema_hash<Format, value_t<element_t<Value>>>(hash);
+		}
+		else if constexpr (kind == eKind::packed)
+		{
+			node(eSchema::packed, uint64_t(Value::packing));
+			hash = schema_hash<Format, element_t<Value>>(hash);
+		}
+		else if constexpr (kind == eKind::aggregate)
+		{
+			node(eSchema::fields, 0);
+			hash = fields_hash<Format>(hash, static_cast<aggregate_t<Value>*>(nullptr));
+		}
+		else
+			// User defined read/write, only the size is known
+			node(eSchema::custom, sizeof(Value));
+
+		return hash;
+	}
+
+	template <typename Format, typename ... Objects>
+	constexpr uint64_t fingerprint() noexcept
+	{
+		uint64_t hash{ 0xCBF29CE484222325 };
 
+		// Options changing the bytes written
+		hash = fnv1a(hash, std::is_same_v<typename Format::length, VarintLength> ? 0 : sizeof(size_t));
+		hash = fnv1a(hash, Format::endian == std::endian::little ? 0 : 1);
+
+		hash = fnv1a(hash, sizeof...(Objects));
+		((hash = schema_hash<Format, Objects>(hash)), ...);
+		return hash;
+	}
+
+	// Skipping
+
+	// Counts the bytes written, to size elements without a known size
+	struct ByteCounter
+	{
+		constexpr ByteCounter& write(char const*, std::streamsize count) noexcept
+		{
+			bytes += uint64_t(count);
+			return *this;
+		}
+
+		uint64_t bytes{};
+	};
+
+	template <typename Format, typename Object>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	uint64_t encoded_size(Object const& object)
+	{
+		if constexpr (is_sizable<Object>())
+			return size_of<Format>(object);
+		else
+		{
+			ByteCounter counter{};
+			parse_object<WRITE, Format>(counter, object);
+			return counter.bytes;
+		}
+	}
+
+	// Read past count bytes
+	template <typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	void skip(Stream& stream, uint64_t count)
+	{
+		if constexpr (is_viewable_v<Stream>)
+			stream.view(size_t(count));
+		else
+		{
+			std::array<char, 4096> block{};
+			for (; count != 0; count -= std::min<uint64_t>(count, block.size()))
+				stream.read(block.data(), std::streamsize(std::min<uint64_t>(count, block.size())));
+		}
+	}
+
+	// Read past count values of size bytes and extra bytes after them
+	// False when a corrupt count wraps the distance around or it exceeds the bytes left
+	template <typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool skip_values(Stream& stream, uint64_t count, uint64_t size, uint64_t extra = 0)
+	{
+		uint64_t left = std::numeric_limits<uint64_t>::max();
+		if constexpr (is_viewable_v<Stream> && requires { stream.size(); })
+			left = uint64_t(stream.size());
+
+		if (size != 0 && count > left / size)
+			return result_fail;
+		if (extra > left - count * size)
+			return result_fail;
+
+		skip(stream, count * size + extra);
+		return result_success;
+	}
+
+	// Raw bytes to or from a stream
+	template <typename Stream>
+	constexpr void write_raw(Stream& stream, std::span<std::byte const> bytes)
+	{
+		if (std::is_constant_evaluated())
+			for (std::byte byte : bytes)
+			{
+				char const c = char(byte);
+				stream.write(&c, 1);
+			}
+		else if (!bytes.empty())
+			stream.write(reinterpret_cast<char const*>(bytes.data()), std::streamsize(bytes.size()));
+	}
+
+	template <typename Stream>
+	constexpr void read_raw(Stream& stream, std::span<std::byte> bytes)
+	{
+		if (std::is_constant_evaluated())
+			for (std::byte& byte : bytes)
+			{
+				char c{};
+				stream.read(&c, 1);
+				byte = std::byte(c);
+			}
+		else if (!bytes.empty())
+			stream.read(reinterpret_cast<char*>(bytes.data()), std::streamsize(bytes.size()));
+	}
+
+	// Count bytes read into a vector that grows in parts as they arrive
+	// A corrupt count fails at the end of the stream before all of it is allocated
+	template <typename Stream>
+	constexpr bool read_growing(Stream& stream, std::vector<std::byte>& bytes, size_t count)
+	{
+		for (size_t done = 0; done != count; )
+		{
+			size_t const part = std::min(count - done, std::max<size_t>(done, 64 * 1024));
+			bytes.resize(done + part);
+			read_raw(stream, std::span{ bytes }.subspan(done));
+			done += part;
+
+			if constexpr (has_streambuf_v<Stream>)
+				if (failed(stream))
+					return result_fail;
+		}
+		return result_success;
+	}
+
+	// Read-only stream over bytes, positioned anywhere
+	class ByteReader
+	{
+	public:
+
+		constexpr explicit ByteReader(std::span<std::byte const> bytes) noexcept
+			: m_Bytes{ bytes }
+		{}
+
+		constexpr ByteReader& read(char* dest, std::streamsize count)
+		{
+			auto const bytes = view(size_t(count));
+
+			if (std::is_constant_evaluated())
+				for (size_t i = 0; i < bytes.size(); ++i)
+					dest[i] = char(bytes[i]);
+			else if (!bytes.empty())
+				std::memcpy(dest, bytes.data(), bytes.size());
+
+			return *this;
+		}
+
+		// View bytes (no copy)
+		constexpr std::span<std::byte const> view(size_t count)
+		{
+			if (count > m_Bytes.size() - m_Position)
+				throw std::runtime_error{ "Reading past the end of the bytes" };
+
+			auto const bytes = m_Bytes.subspan(m_Position, count);
+			m_Position += count;
+			return bytes;
+		}
+		//
+		// View values (no copy), the bytes must be aligned for Val
+		template <typename Val> requires std::is_trivially_copyable_v<Val>
+		std::span<Val const> view(size_t count)
+		{
+			if (reinterpret_cast<std::uintptr_t>(m_Bytes.data() + m_Position) % alignof(Val) != 0)
+				throw std::runtime_error{ "Bytes are misaligned for view" };
+
+			if (count > size() / sizeof(Val))
+				throw std::runtime_error{ "Reading past the end of the bytes" };
+
+			return { reinterpret_cast<Val const*>(view(count * sizeof(Val)).data()), count };
+		}
+
+		// Bytes left to read
+		constexpr size_t size() const noexcept
+		{
+			return m_Bytes.size() - m_Position;
+		}
+
+		constexpr std::streamoff tellg() const noexcept
+		{
+			return std::streamoff(m_Position);
+		}
+
+		constexpr ByteReader& seekg(size_t position)
+		{
+			if (position > m_Bytes.size())
+				throw std::runtime_error{ "Seeking past the end of the bytes" };
+
+			m_Position = position;
+			return *this;
+		}
+
+	private:
+
+		std::span<std::byte const> m_Bytes;
+		size_t m_Position{};
+	};
+
+	// Read past an object without decoding it, arrays of trivially copyable values in one step
+	template <typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool skip_object(Stream& stream)
+	{
+		if constexpr (constexpr auto kind = parse_kind<Object>(); kind == eKind::trivial)
+		{
+			skip(stream, value_size<Format, Object>());
+			return result_success;
+		}
+		else if constexpr (kind == eKind::view || kind == eKind::itterable)
+		{
+			using T = element_t<Object>;
+
+			decltype(std::size(std::declval<Object&>())) count{};
+			if (!parse_length<READ, Format>(stream, count))
+				return result_fail;
+
+			if constexpr (kind == eKind::view || (std::is_trivially_copyable_v<T> && is_contiguous_container_v<Object>))
+				return skip_values(stream, uint64_t(count), value_size<Format, T>());
+			else
+			{
+				for (; count != 0; --count)
+					if (!skip_object<Format, value_t<T>>(stream))
+						return result_fail;
 				return result_success;
 			}
 		}
+		else if constexpr (kind == eKind::aggregate)
+		{
+			return []<typename ... Fields>(Stream& stream, std::tuple<Fields...>*)
+			{
+				return (skip_object<Format, std::remove_cvref_t<Fields>>(stream) && ...);
+			}
+			(stream, static_cast<aggregate_t<Object>*>(nullptr));
+		}
+		else if constexpr (kind == eKind::indexed)
+		{
+			size_t count{};
+			uint64_t bytes{};
+			if (!parse_length<READ, Format>(stream, count) || !parse_object<READ, Format>(stream, bytes))
+				return result_fail;
+
+			// Elements, then the offset table
+			if (bytes > std::numeric_limits<uint64_t>::max() - length_size<Format>(count))
+				return result_fail;
+			return skip_values(stream, count, sizeof(uint64_t), bytes + length_size<Format>(count));
+		}
+		else if constexpr (kind == eKind::parallel)
+		{
+			size_t count{};
+			uint64_t elements{};
+			std::vector<uint64_t> sizes;
+			if (!parse_length<READ, Format>(stream, count) || !parse_object<READ, Format>(stream, elements) || !parse_object<READ, Format>(stream, sizes))
+				return result_fail;
+
+			uint64_t bytes{};
+			for (uint64_t size : sizes)
+			{
+				if (size > std::numeric_limits<uint64_t>::max() - bytes)
+					return result_fail;
+				bytes += size;
+			}
+
+			skip(stream, bytes);
+			return result_success;
+		}
+		else if constexpr (kind == eKind::packed)
+		{
+			size_t count{}, bytes{};
+			if (!parse_length<READ, Format>(stream, count) || !parse_length<READ, Format>(stream, bytes))
+				return result_fail;
+
+			skip(stream, bytes);
+			return result_success;
+		}
+		else
+		{
+			// User defined read, decoded to skip it
+			Object object{};
+			return parse_object<READ, Format>(stream, object);
+		}
 	}
 
+	template <typename Stream>
+	constexpr static bool is_preparable_v<Stream, std::void_t<decltype(std::declval<Stream&>().prepare(size_t{}))>> = true;
+
+	template <typename Stream>
+	constexpr static bool is_reservable_v<Stream, std::void_t<decltype(std::declval<Stream&>().reserve(size_t{}))>> = true;
+
 	// Any
 
-	template <bool W, typename Object, typename Stream>
+	template <bool W, typename Format, typename Object, typename Stream>
 #if defined(__cpp_lib_bit_cast)
 	constexpr
 #endif
@@ -296,11 +1651,31 @@ namespace detail
 	{
 		if constexpr (constexpr auto kind = parse_kind<Object>(); kind == eKind::trivial)
 		{
-			return parse_pod<W>(stream, object);
+			return parse_value<W, Format>(stream, object);
 		}
 		else if constexpr (kind == eKind::itterable)
 		{
-			return parse_container<W>(stream, object);
+			return parse_container<W, Format>(stream, object);
+		}
+		else if constexpr (kind == eKind::view)
+		{
+			return parse_view<W, Format>(stream, object);
+		}
+		else if constexpr (kind == eKind::aggregate)
+		{
+			return parse_fields<W, Format>(stream, object);
+		}
+		else if constexpr (kind == eKind::indexed)
+		{
+			return parse_indexed<W, Format>(stream, object);
+		}
+		else if constexpr (kind == eKind::parallel)
+		{
+			return parse_parallel<W, Format>(stream, object);
+		}
+		else if constexpr (kind == eKind::packed)
+		{
+			return parse_packed<W, Format>(stream, object);
 		}
 		else if constexpr (kind == eKind::pointer)
 		{
@@ -312,6 +1687,22 @@ namespace detail
 		else return result_fail;
 	}
 
+	// Parsable objects in a format, or user defined read/write
+
+	template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+	constexpr
+#endif
+	bool parse_object(Stream& stream, Object& object)
+	{
+		if constexpr (is_parsable<Object>::value)
+			return parse_any<W, Format>(stream, object);
+		else if constexpr (W)
+			return write(stream, object);
+		else // R
+			return read(stream, object);
+	}
+
 }
 
 	template <typename Object, typename Stream>
@@ -320,7 +1711,7 @@ namespace detail
 #endif
 	auto read(Stream& stream, Object& object) -> detail::enable_if_parsable_t<Object, bool>
 	{
-		return detail::parse_any<detail::READ>(stream, object);
+		return detail::parse_any<detail::READ, DefaultFormat>(stream, object);
 	}
 
 	template <typename Object, typename Stream>
@@ -329,10 +1720,102 @@ namespace detail
 #endif
 	auto write(Stream& stream, Object const& object) -> detail::enable_if_parsable_t<Object, bool>
 	{
-		return detail::parse_any<detail::WRITE>(stream, object);
+		return detail::parse_any<detail::WRITE, DefaultFormat>(stream, object);
 	}
 
 
+	//
+	// Lazy view of a layout written in bytes, decodes objects on access
+	// Objects are found skipping over them once, arrays of trivially copyable values in one step,
+	// or from the offset table written by BasicLayout::WriteWithOffsets.
+	// The bytes of an object or of the whole layout can be forwarded without decoding.
+	//
+	template <typename Format, typename ... Objects>
+	class LayoutView
+	{
+
+		static constexpr size_t count = sizeof...(Objects);
+
+	public:
+
+		template <size_t I>
+		using type = std::tuple_element_t<I, std::tuple<Objects...>>;
+
+		constexpr explicit LayoutView(std::span<std::byte const> bytes, eFieldOffsets offsets = eFieldOffsets::scan)
+		{
+			detail::ByteReader reader{ bytes };
+
+			if (offsets == eFieldOffsets::table)
+			{
+				std::array<uint64_t, count + 1> table{};
+				if (!detail::parse_object<detail::READ, Format>(reader, table))
+					throw std::runtime_error{ "Read failed" };
+
+				// Untrusted, offsets must be in order and within the bytes
+				for (size_t i = 0; i < count; ++i)
+					if (table[i] > table[i + 1])
+						throw std::runtime_error{ "Layout offsets out of order" };
+
+				if (table[count] > reader.size())
+					throw std::runtime_error{ "Layout exceeds the bytes" };
+
+				for (size_t i = 0; i <= count; ++i)
+					m_Offsets[i] = size_t(reader.tellg()) + size_t(table[i]);
+			}
+			else
+			{
+				size_t i{};
+				bool const skipped = ((m_Offsets[i++] = size_t(reader.tellg()), detail::skip_object<Format, Objects>(reader)) && ...);
+				if (!skipped)
+					throw std::runtime_error{ "Read failed" };
+
+				m_Offsets[count] = size_t(reader.tellg());
+			}
+
+			m_Bytes = bytes.first(m_Offsets[count]);
+		}
+
+		// Decode object I
+		template <size_t I>
+		constexpr type<I> get() const
+		{
+			detail::ByteReader reader{ m_Bytes };
+			reader.seekg(m_Offsets[I]);
+
+			type<I> object{};
+			if (!detail::parse_object<detail::READ, Format>(reader, object))
+				throw std::runtime_error{ "Read failed" };
+
+			return object;
+		}
+
+		// Encoded bytes of object I
+		template <size_t I>
+		constexpr std::span<std::byte const> bytes() const noexcept
+		{
+			return m_Bytes.subspan(m_Offsets[I], m_Offsets[I + 1] - m_Offsets[I]);
+		}
+
+		// Encoded bytes of the layout, with its offset table if any
+		constexpr std::span<std::byte const> bytes() const noexcept
+		{
+			return m_Bytes;
+		}
+
+		constexpr size_t size() const noexcept
+		{
+			return m_Bytes.size();
+		}
+
+	private:
+
+		std::span<std::byte const> m_Bytes;
+
+		// Start of every object and the end of the last one
+		std::array<size_t, count + 1> m_Offsets{};
+
+	};
+
 #pragma endregion
 
 }
\ No newline at end of file
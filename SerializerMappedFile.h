@@ -0,0 +1,302 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <utility>
+#include <filesystem>
+#include <system_error>
+
+#include "ConstexprSerializerBuffer.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Serializer over a memory mapped file
+// Reading maps an existing file read-only, all of its bytes are queued for reading.
+// Writing creates the file with a capacity mapped read-write, it is truncated to the written bytes when closed.
+class MappedSerializer : private detail::SerializerBase
+{
+public:
+
+	enum class eAdvice
+	{
+		normal,
+		sequential,
+		random,
+		willneed,
+		dontneed
+	};
+
+	using SerializerBase::read;
+	using SerializerBase::write;
+	using SerializerBase::view;
+	using SerializerBase::size;
+	using SerializerBase::queued;
+	using SerializerBase::prepare;
+	using SerializerBase::commit;
+
+	// Map an existing file for reading
+	explicit MappedSerializer(std::filesystem::path const& path)
+		: m_Mode{ eMode::read }
+	{
+		open(path, 0);
+	}
+
+	// Create a file of capacity bytes for writing
+	MappedSerializer(std::filesystem::path const& path, size_t capacity)
+		: m_Mode{ eMode::write }
+	{
+		open(path, capacity);
+	}
+
+	// Copy
+	MappedSerializer(MappedSerializer const&) = delete;
+	MappedSerializer& operator = (MappedSerializer const&) = delete;
+
+	// Move
+	MappedSerializer(MappedSerializer&& other) noexcept
+		: SerializerBase{ std::move(other) }
+		, m_Mode{ other.m_Mode }
+		, m_Mapping{ std::exchange(other.m_Mapping, {}) }
+		, m_File{ std::exchange(other.m_File, invalid_file) }
+#if defined(_WIN32)
+		, m_Map{ std::exchange(other.m_Map, nullptr) }
+#endif
+	{}
+
+	MappedSerializer& operator = (MappedSerializer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			SerializerBase::operator = (std::move(other));
+			m_Mode = other.m_Mode;
+			m_Mapping = std::exchange(other.m_Mapping, {});
+			m_File = std::exchange(other.m_File, invalid_file);
+#if defined(_WIN32)
+			m_Map = std::exchange(other.m_Map, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+	~MappedSerializer()
+	{
+		close();
+	}
+
+	// Clear buffer
+	// Reading queues the whole file again, writing marks it as overwritable
+	void clear()
+	{
+		reset_buffer(m_Mapping);
+
+		if (m_Mode == eMode::read)
+			commit(m_Mapping.size());
+	}
+
+	// Access pattern hint for the mapped pages
+	void advise(eAdvice advice) const noexcept
+	{
+		if (m_Mapping.empty())
+			return;
+
+#if defined(_WIN32)
+		// Only prefetching is supported
+		if (advice == eAdvice::willneed)
+		{
+			WIN32_MEMORY_RANGE_ENTRY range{ m_Mapping.data(), m_Mapping.size() };
+			PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+		}
+#else
+		int const flags[]{ MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED };
+		madvise(m_Mapping.data(), m_Mapping.size(), flags[size_t(advice)]);
+#endif
+	}
+
+	// Write modified pages to the file
+	void flush()
+	{
+		if (m_Mode != eMode::write || m_Mapping.empty())
+			return;
+
+#if defined(_WIN32)
+		if (!FlushViewOfFile(m_Mapping.data(), 0))
+			throw_error("Flushing mapped file failed");
+#else
+		if (msync(m_Mapping.data(), m_Mapping.size(), MS_SYNC) != 0)
+			throw_error("Flushing mapped file failed");
+#endif
+	}
+
+	// Mapped bytes
+	size_t capacity() const noexcept
+	{
+		return m_Mapping.size();
+	}
+
+private:
+
+	enum class eMode
+	{
+		read,
+		write
+	};
+
+#if defined(_WIN32)
+	using File = HANDLE;
+	static inline File const invalid_file = INVALID_HANDLE_VALUE;
+#else
+	using File = int;
+	static constexpr File invalid_file = -1;
+#endif
+
+	[[noreturn]] static void throw_error(char const* message)
+	{
+#if defined(_WIN32)
+		throw std::system_error{ int(GetLastError()), std::system_category(), message };
+#else
+		throw std::system_error{ errno, std::system_category(), message };
+#endif
+	}
+
+	void open(std::filesystem::path const& path, size_t capacity)
+	{
+		try
+		{
+			map(path, capacity);
+		}
+		catch (...)
+		{
+			// The destructor does not run for a throwing constructor
+			close();
+			throw;
+		}
+	}
+
+	void map(std::filesystem::path const& path, size_t capacity)
+	{
+		bool const write = m_Mode == eMode::write;
+
+#if defined(_WIN32)
+		m_File = CreateFileW(
+			path.c_str(),
+			write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			write ? CREATE_ALWAYS : OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr
+		);
+		if (m_File == invalid_file)
+			throw_error("Opening mapped file failed");
+
+		if (!write)
+		{
+			LARGE_INTEGER size{};
+			if (!GetFileSizeEx(m_File, &size))
+				throw_error("Reading mapped file size failed");
+			capacity = size_t(size.QuadPart);
+		}
+
+		if (capacity != 0)
+		{
+			m_Map = CreateFileMappingW(m_File, nullptr, write ? PAGE_READWRITE : PAGE_READONLY, DWORD(uint64_t(capacity) >> 32), DWORD(capacity), nullptr);
+			if (!m_Map)
+				throw_error("Mapping file failed");
+
+			auto const data = MapViewOfFile(m_Map, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, capacity);
+			if (!data)
+				throw_error("Mapping file failed");
+
+			m_Mapping = { static_cast<std::byte*>(data), capacity };
+		}
+#else
+		m_File = ::open(path.c_str(), write ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+		if (m_File == invalid_file)
+			throw_error("Opening mapped file failed");
+
+		if (write)
+		{
+			if (ftruncate(m_File, off_t(capacity)) != 0)
+				throw_error("Resizing mapped file failed");
+		}
+		else
+		{
+			struct stat status{};
+			if (fstat(m_File, &status) != 0)
+				throw_error("Reading mapped file size failed");
+			capacity = size_t(status.st_size);
+		}
+
+		if (capacity != 0)
+		{
+			auto const data = mmap(nullptr, capacity, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_File, 0);
+			if (data == MAP_FAILED)
+				throw_error("Mapping file failed");
+
+			m_Mapping = { static_cast<std::byte*>(data), capacity };
+		}
+#endif
+
+		clear();
+	}
+
+	void close() noexcept
+	{
+		if (m_File == invalid_file)
+			return;
+
+		// Bytes up to the end of the written ones
+		size_t const used = m_Mapping.empty() ? 0 : size_t(prepare(0).data() - m_Mapping.data());
+
+#if defined(_WIN32)
+		if (!m_Mapping.empty())
+			UnmapViewOfFile(m_Mapping.data());
+		if (m_Map)
+			CloseHandle(m_Map);
+
+		if (m_Mode == eMode::write)
+		{
+			LARGE_INTEGER const end{ .QuadPart = LONGLONG(used) };
+			SetFilePointerEx(m_File, end, nullptr, FILE_BEGIN);
+			SetEndOfFile(m_File);
+		}
+
+		CloseHandle(m_File);
+		m_Map = nullptr;
+#else
+		if (!m_Mapping.empty())
+			munmap(m_Mapping.data(), m_Mapping.size());
+
+		if (m_Mode == eMode::write)
+			(void)ftruncate(m_File, off_t(used));
+
+		::close(m_File);
+#endif
+
+		m_Mapping = {};
+		m_File = invalid_file;
+		reset_buffer({});
+	}
+
+	eMode m_Mode;
+
+	std::span<std::byte> m_Mapping{};
+
+	File m_File{ invalid_file };
+#if defined(_WIN32)
+	HANDLE m_Map{};
+#endif
+
+};
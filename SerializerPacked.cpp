@@ -0,0 +1,92 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerPacked.h"
+
+#include <vector>
+#include <cstdint>
+
+using serializer_helper::Layout;
+using serializer_helper::BasicLayout;
+using serializer_helper::ReuseFormat;
+using serializer_helper::VarintFormat;
+using serializer_helper::Packed;
+using serializer_helper::ePacking;
+
+static_assert(
+	[]
+	{
+		// A full block and a short one, sorted ids
+		Packed<std::vector<uint32_t>> ids;
+		for (uint32_t i = 0; i < 200; ++i)
+			ids.push_back(1'000'000 + i * 3);
+
+		// Timestamps going back and forth
+		Packed<std::vector<int64_t>> times{ -5, 1'650'000'000'000, 1'650'000'000'250, 1'649'999'999'990, INT64_MIN, INT64_MAX };
+
+		Serializer io(SerializerGrowth{});
+		Layout<decltype(ids)>::Write(io, ids);
+		size_t const size = io.size();
+		Layout<decltype(times), int>::Write(io, times, 7);
+
+		auto const [ids2, times2, after] = Layout<decltype(ids), decltype(times), int>::Read(io);
+
+		// Differences of 3 take 3 bits instead of 32
+		return ids2 == ids && times2 == times && after == 7
+			&& size * 6 < 200 * sizeof(uint32_t);
+	}
+	(),
+	"Delta packing"
+);
+
+static_assert(
+	[]
+	{
+		Packed<std::vector<int16_t>, ePacking::frame> readings;
+		for (int i = 0; i < 300; ++i)
+			readings.push_back(int16_t(-1000 + i % 16));
+
+		Packed<std::vector<uint64_t>, ePacking::frame> constant(128, 42), none{};
+
+		using Readings = BasicLayout<VarintFormat, decltype(readings), decltype(constant), decltype(none)>;
+
+		Serializer io(SerializerGrowth{});
+		BasicLayout<VarintFormat, decltype(readings)>::Write(io, readings);
+		size_t const size = io.size();
+		BasicLayout<VarintFormat, decltype(constant), decltype(none)>::Write(io, constant, none);
+		size_t const equal = io.size() - size;
+
+		auto const [readings2, constant2, none2] = Readings::Read(io);
+
+		// Values within 16 of the smallest take 4 bits instead of 16, equal ones none
+		return readings2 == readings && constant2 == constant && none2.empty()
+			&& size * 3 < 300 * sizeof(int16_t) && equal < 16;
+	}
+	(),
+	"Frame of reference packing"
+);
+
+static_assert(
+	[]
+	{
+		Packed<std::vector<uint8_t>> bytes{ 0, 255, 1, 254 }, existing{ 9, 9 };
+
+		Serializer io(SerializerGrowth{});
+		Layout<decltype(bytes), int>::Write(io, bytes, 7);
+		Layout<decltype(bytes)>::Write(io, bytes);
+
+		// Skipped in one step, then read over existing values
+		bool const viewed = Layout<decltype(bytes), int>::View{ io.queued() }.get<1>() == 7;
+		auto const [appended, after] = Layout<decltype(bytes), int>::Read(io);
+		BasicLayout<ReuseFormat, decltype(bytes)>::Read(io, existing);
+
+		return viewed && appended == bytes && after == 7 && existing == bytes;
+	}
+	(),
+	"Packed views and reuse"
+);
+
+// Packed containers hash apart from plain ones, and by packing
+static_assert(Layout<Packed<std::vector<uint32_t>>>::fingerprint() != Layout<std::vector<uint32_t>>::fingerprint());
+static_assert(Layout<Packed<std::vector<uint32_t>>>::fingerprint() != Layout<Packed<std::vector<uint32_t>, ePacking::frame>>::fingerprint());
@@ -0,0 +1,617 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <bit>
+#include <span>
+#include <array>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerIostreamHelper.h"
+
+#if (defined(__SSE4_1__) || defined(__AVX__)) && (defined(__x86_64__) || defined(_M_X64))
+#define SERIALIZER_PACK_SSE41
+#if defined(__AVX2__)
+#include <immintrin.h>
+#else
+#include <smmintrin.h>
+#endif
+#endif
+
+namespace serializer_helper
+{
+
+	enum class ePacking
+	{
+		// Differences of consecutive values, zigzag coded so small negative ones stay small, for sorted ids and timestamps
+		delta,
+		// Offsets from the smallest value of each block, for values in a narrow range
+		frame
+	};
+
+	//
+	// Container of integers written bit packed
+	// Values are coded per block of 128 (delta or frame of reference) and packed with as many bits as the block needs.
+	// Written as: count, byte size, then per block its bit width, its first (delta) or smallest value (frame) and the packed bits.
+	// Blocks decode independently of each other.
+	// Packing uses SSE4.1 and AVX2 where enabled, and a scalar path producing the same bytes otherwise and during constant evaluation.
+	// Containers must be contiguous and resizable, like std::vector.
+	//
+	template <typename Cont, ePacking PACKING = ePacking::delta>
+	struct Packed : Cont
+	{
+		static_assert(std::is_integral_v<typename Cont::value_type> && !std::is_same_v<typename Cont::value_type, bool>, "Packed values are integers");
+
+		using container_type = Cont;
+
+		static constexpr ePacking packing = PACKING;
+
+		using Cont::Cont;
+
+		constexpr Packed() = default;
+
+		constexpr Packed(Cont container)
+			: Cont(std::move(container))
+		{}
+	};
+
+	namespace detail
+	{
+		// Values per block
+		constexpr size_t pack_block = 128;
+
+		// Words values are packed from, 4 lanes of 32 bits or 2 of 64 in 16 bytes
+		template <typename T>
+		using pack_word_t = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+
+		template <typename U>
+		constexpr U zigzag(U value) noexcept
+		{
+			return U(U(value << 1) ^ U(0 - (value >> (sizeof(U) * 8 - 1))));
+		}
+
+		template <typename U>
+		constexpr U unzigzag(U value) noexcept
+		{
+			return U(U(value >> 1) ^ U(0 - (value & 1)));
+		}
+
+		// Bytes of count values packed with width bits each
+		// Full blocks are packed per lane (value i in lane i % lanes), others as one little endian bit stream
+		constexpr size_t packed_size(size_t count, unsigned width) noexcept
+		{
+			return count == pack_block ? width * size_t{ 16 } : (count * width + 7) / 8;
+		}
+
+		// Bit width and reference value
+		template <typename T>
+		constexpr size_t block_header_size = 1 + sizeof(T);
+
+		// Little endian integers of sizeof(T) bytes
+		template <typename T>
+		constexpr void store_le(T value, std::byte* out) noexcept
+		{
+			for (size_t i = 0; i < sizeof(T); ++i)
+				out[i] = std::byte(std::make_unsigned_t<T>(value) >> (i * 8));
+		}
+
+		template <typename T>
+		constexpr T load_le(std::byte const* in) noexcept
+		{
+			std::make_unsigned_t<T> value{};
+			for (size_t i = 0; i < sizeof(T); ++i)
+				value |= std::make_unsigned_t<T>(std::make_unsigned_t<T>(in[i]) << (i * 8));
+			return T(value);
+		}
+
+		template <typename W>
+		constexpr void store_words(W const* words, size_t count, std::byte* out) noexcept
+		{
+			if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+				std::memcpy(out, words, count * sizeof(W));
+			else
+				for (size_t i = 0; i < count; ++i)
+					store_le(words[i], out + i * sizeof(W));
+		}
+
+		template <typename W>
+		constexpr void load_words(std::byte const* in, size_t count, W* words) noexcept
+		{
+			if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+				std::memcpy(words, in, count * sizeof(W));
+			else
+				for (size_t i = 0; i < count; ++i)
+					words[i] = load_le<W>(in + i * sizeof(W));
+		}
+
+#if defined(SERIALIZER_PACK_SSE41)
+		// Kernels on values of Size bytes, 4 or 8
+
+		template <size_t Size>
+		inline __m128i sub(__m128i a, __m128i b) noexcept { return Size == 4 ? _mm_sub_epi32(a, b) : _mm_sub_epi64(a, b); }
+
+		template <size_t Size>
+		inline __m128i add(__m128i a, __m128i b) noexcept { return Size == 4 ? _mm_add_epi32(a, b) : _mm_add_epi64(a, b); }
+
+		template <size_t Size>
+		inline __m128i shift_left(__m128i a, int count) noexcept { return Size == 4 ? _mm_sll_epi32(a, _mm_cvtsi32_si128(count)) : _mm_sll_epi64(a, _mm_cvtsi32_si128(count)); }
+
+		template <size_t Size>
+		inline __m128i shift_right(__m128i a, int count) noexcept { return Size == 4 ? _mm_srl_epi32(a, _mm_cvtsi32_si128(count)) : _mm_srl_epi64(a, _mm_cvtsi32_si128(count)); }
+
+		template <size_t Size>
+		inline __m128i broadcast(uint64_t value) noexcept { return Size == 4 ? _mm_set1_epi32(int32_t(value)) : _mm_set1_epi64x(int64_t(value)); }
+
+		template <size_t Size>
+		inline __m128i zigzag(__m128i d) noexcept
+		{
+			return Size == 4
+				? _mm_xor_si128(_mm_slli_epi32(d, 1), _mm_srai_epi32(d, 31))
+				: _mm_xor_si128(_mm_slli_epi64(d, 1), _mm_sub_epi64(_mm_setzero_si128(), _mm_srli_epi64(d, 63)));
+		}
+
+#if defined(__AVX2__)
+		template <size_t Size>
+		inline __m256i zigzag(__m256i d) noexcept
+		{
+			return Size == 4
+				? _mm256_xor_si256(_mm256_slli_epi32(d, 1), _mm256_srai_epi32(d, 31))
+				: _mm256_xor_si256(_mm256_slli_epi64(d, 1), _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_srli_epi64(d, 63)));
+		}
+#endif
+
+		// Zigzag coded differences of values [i, count) to the ones in front of them, returns where it stopped
+		template <size_t Size>
+		inline size_t encode_delta_simd(std::byte const* values, size_t count, size_t i, std::byte* words) noexcept
+		{
+#if defined(__AVX2__)
+			for (; i + 32 / Size <= count; i += 32 / Size)
+			{
+				__m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(values + i * Size));
+				__m256i const p = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(values + (i - 1) * Size));
+				__m256i const d = Size == 4 ? _mm256_sub_epi32(x, p) : _mm256_sub_epi64(x, p);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(words + i * Size), zigzag<Size>(d));
+			}
+#endif
+			for (; i + 16 / Size <= count; i += 16 / Size)
+			{
+				__m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(values + i * Size));
+				__m128i const p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(values + (i - 1) * Size));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(words + i * Size), zigzag<Size>(sub<Size>(x, p)));
+			}
+			return i;
+		}
+
+		// Prefix sums of the zigzag decoded differences, following previous, returns the last value
+		template <size_t Size>
+		inline uint64_t decode_delta_simd(std::byte const* words, size_t count, uint64_t previous, std::byte* values) noexcept
+		{
+			__m128i last = broadcast<Size>(previous);
+			__m128i const one = broadcast<Size>(1);
+			for (size_t i = 0; i < count; i += 16 / Size)
+			{
+				__m128i const z = _mm_loadu_si128(reinterpret_cast<__m128i const*>(words + i * Size));
+				__m128i x = _mm_xor_si128(shift_right<Size>(z, 1), sub<Size>(_mm_setzero_si128(), _mm_and_si128(z, one)));
+
+				// Sum across the lanes, then add the last value of the lanes before
+				if constexpr (Size == 4)
+					x = add<Size>(x, _mm_slli_si128(x, 4));
+				x = add<Size>(add<Size>(x, _mm_slli_si128(x, 8)), last);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i * Size), x);
+				last = Size == 4 ? _mm_shuffle_epi32(x, 0xFF) : _mm_shuffle_epi32(x, 0xEE);
+			}
+			return Size == 4 ? uint32_t(_mm_extract_epi32(last, 0)) : uint64_t(_mm_extract_epi64(last, 0));
+		}
+
+		// Values minus or plus reference, returns where it stopped
+		template <size_t Size, bool ENCODE>
+		inline size_t frame_simd(std::byte const* src, size_t count, uint64_t reference, std::byte* dest) noexcept
+		{
+			size_t i = 0;
+#if defined(__AVX2__)
+			__m256i const wide = Size == 4 ? _mm256_set1_epi32(int32_t(reference)) : _mm256_set1_epi64x(int64_t(reference));
+			for (; i + 32 / Size <= count; i += 32 / Size)
+			{
+				__m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i * Size));
+				__m256i const y = ENCODE
+					? (Size == 4 ? _mm256_sub_epi32(x, wide) : _mm256_sub_epi64(x, wide))
+					: (Size == 4 ? _mm256_add_epi32(x, wide) : _mm256_add_epi64(x, wide));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * Size), y);
+			}
+#endif
+			__m128i const narrow = broadcast<Size>(reference);
+			for (; i + 16 / Size <= count; i += 16 / Size)
+			{
+				__m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i * Size));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * Size), ENCODE ? sub<Size>(x, narrow) : add<Size>(x, narrow));
+			}
+			return i;
+		}
+
+		// A full block of words packed per lane, a 16 byte word of all lanes at a time
+		template <typename W>
+		inline void pack_block_simd(W const* words, unsigned width, std::byte* out) noexcept
+		{
+			constexpr size_t lanes = 16 / sizeof(W);
+			constexpr unsigned bits = sizeof(W) * 8;
+
+			__m128i packed = _mm_setzero_si128();
+			unsigned shift = 0;
+			for (size_t row = 0; row < pack_block / lanes; ++row)
+			{
+				__m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(words + row * lanes));
+				packed = _mm_or_si128(packed, shift_left<sizeof(W)>(v, int(shift)));
+
+				shift += width;
+				if (shift >= bits)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+					out += 16;
+					shift -= bits;
+					packed = shift != 0 ? shift_right<sizeof(W)>(v, int(width - shift)) : _mm_setzero_si128();
+				}
+			}
+		}
+
+		template <typename W>
+		inline void unpack_block_simd(std::byte const* in, unsigned width, W* words) noexcept
+		{
+			constexpr size_t lanes = 16 / sizeof(W);
+			constexpr size_t rows = pack_block / lanes;
+			constexpr unsigned bits = sizeof(W) * 8;
+
+			__m128i const mask = width == bits ? _mm_set1_epi32(-1) : broadcast<sizeof(W)>((uint64_t{ 1 } << width) - 1);
+
+			__m128i packed = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in));
+			unsigned shift = 0;
+			for (size_t row = 0; row < rows; ++row)
+			{
+				__m128i v = shift_right<sizeof(W)>(packed, int(shift));
+
+				shift += width;
+				if (shift >= bits && row + 1 != rows)
+				{
+					in += 16;
+					packed = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in));
+					shift -= bits;
+					if (shift != 0)
+						v = _mm_or_si128(v, shift_left<sizeof(W)>(packed, int(width - shift)));
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(words + row * lanes), _mm_and_si128(v, mask));
+			}
+		}
+#endif
+
+		// Words of count values, differences starting from reference (delta) or offsets from it (frame)
+		template <ePacking PACKING, typename T, typename W>
+		constexpr void encode_values(T const* values, size_t count, T reference, W* words) noexcept
+		{
+			using U = std::make_unsigned_t<T>;
+
+			size_t i = 0;
+			U previous = U(reference);
+
+#if defined(SERIALIZER_PACK_SSE41)
+			if constexpr (sizeof(T) == sizeof(W))
+				if (!std::is_constant_evaluated() && count > 1)
+				{
+					auto const src = reinterpret_cast<std::byte const*>(values);
+					auto const dest = reinterpret_cast<std::byte*>(words);
+					if constexpr (PACKING == ePacking::delta)
+					{
+						words[0] = W(zigzag(U(U(values[0]) - previous)));
+						i = encode_delta_simd<sizeof(T)>(src, count, 1, dest);
+						previous = U(values[i - 1]);
+					}
+					else
+						i = frame_simd<sizeof(T), true>(src, count, uint64_t(U(reference)), dest);
+				}
+#endif
+
+			for (; i < count; ++i)
+			{
+				U const value = U(values[i]);
+				if constexpr (PACKING == ePacking::delta)
+				{
+					words[i] = W(zigzag(U(value - previous)));
+					previous = value;
+				}
+				else
+					words[i] = W(U(value - U(reference)));
+			}
+		}
+
+		// Inverse of encode_values
+		template <ePacking PACKING, typename T, typename W>
+		constexpr void decode_values(W const* words, size_t count, T reference, T* values) noexcept
+		{
+			using U = std::make_unsigned_t<T>;
+
+			size_t i = 0;
+			U previous = U(reference);
+
+#if defined(SERIALIZER_PACK_SSE41)
+			if constexpr (sizeof(T) == sizeof(W))
+				if (!std::is_constant_evaluated())
+				{
+					auto const src = reinterpret_cast<std::byte const*>(words);
+					auto const dest = reinterpret_cast<std::byte*>(values);
+					if constexpr (PACKING == ePacking::delta)
+					{
+						i = count / (16 / sizeof(T)) * (16 / sizeof(T));
+						previous = U(decode_delta_simd<sizeof(T)>(src, i, uint64_t(previous), dest));
+					}
+					else
+						i = frame_simd<sizeof(T), false>(src, count, uint64_t(U(reference)), dest);
+				}
+#endif
+
+			for (; i < count; ++i)
+			{
+				if constexpr (PACKING == ePacking::delta)
+				{
+					previous = U(previous + unzigzag(U(words[i])));
+					values[i] = T(previous);
+				}
+				else
+					values[i] = T(U(U(words[i]) + U(reference)));
+			}
+		}
+
+		// Pack count words with width bits each into packed_size(count, width) bytes
+		template <typename W>
+		constexpr void pack_words(W const* words, size_t count, unsigned width, std::byte* out) noexcept
+		{
+			constexpr size_t lanes = 16 / sizeof(W);
+			constexpr unsigned bits = sizeof(W) * 8;
+
+			if (count == pack_block)
+			{
+#if defined(SERIALIZER_PACK_SSE41)
+				if (!std::is_constant_evaluated())
+				{
+					pack_block_simd(words, width, out);
+					return;
+				}
+#endif
+				// A row of all lanes at a time, like the vector path
+				std::array<W, pack_block> packed{};
+				W* word = packed.data();
+				for (size_t row = 0, shift = 0; row < pack_block / lanes; ++row)
+				{
+					W const* const values = words + row * lanes;
+					for (size_t lane = 0; lane < lanes; ++lane)
+						word[lane] |= W(values[lane] << shift);
+
+					shift += width;
+					if (shift >= bits)
+					{
+						word += lanes;
+						shift -= bits;
+						if (shift != 0)
+							for (size_t lane = 0; lane < lanes; ++lane)
+								word[lane] = W(values[lane] >> (width - shift));
+					}
+				}
+
+				store_words(packed.data(), width * lanes, out);
+				return;
+			}
+
+			std::fill_n(out, packed_size(count, width), std::byte{});
+			for (size_t i = 0, bit = 0; i < count; ++i)
+				for (unsigned done = 0; done != width;)
+				{
+					unsigned const shift = unsigned(bit % 8), take = std::min(8 - shift, width - done);
+					out[bit / 8] |= std::byte((words[i] >> done & ((1u << take) - 1)) << shift);
+					done += take;
+					bit += take;
+				}
+		}
+
+		template <typename W>
+		constexpr void unpack_words(std::byte const* in, size_t count, unsigned width, W* words) noexcept
+		{
+			constexpr size_t lanes = 16 / sizeof(W);
+			constexpr unsigned bits = sizeof(W) * 8;
+
+			if (width == 0)
+			{
+				std::fill_n(words, count, W{});
+				return;
+			}
+
+			if (count == pack_block)
+			{
+#if defined(SERIALIZER_PACK_SSE41)
+				if (!std::is_constant_evaluated())
+				{
+					unpack_block_simd(in, width, words);
+					return;
+				}
+#endif
+				std::array<W, pack_block> packed{};
+				load_words(in, width * lanes, packed.data());
+
+				W const mask = width == bits ? W(~W{}) : W((W{ 1 } << width) - 1);
+				W const* word = packed.data();
+				for (size_t row = 0, shift = 0; row < pack_block / lanes; ++row)
+				{
+					W* const values = words + row * lanes;
+					for (size_t lane = 0; lane < lanes; ++lane)
+						values[lane] = W(word[lane] >> shift);
+
+					shift += width;
+					if (shift >= bits && row + 1 != pack_block / lanes)
+					{
+						word += lanes;
+						shift -= bits;
+						if (shift != 0)
+							for (size_t lane = 0; lane < lanes; ++lane)
+								values[lane] |= W(word[lane] << (width - shift));
+					}
+
+					for (size_t lane = 0; lane < lanes; ++lane)
+						values[lane] &= mask;
+				}
+				return;
+			}
+
+			for (size_t i = 0, bit = 0; i < count; ++i)
+			{
+				W value{};
+				for (unsigned done = 0; done != width;)
+				{
+					unsigned const shift = unsigned(bit % 8), take = std::min(8 - shift, width - done);
+					value |= W(W((unsigned(in[bit / 8]) >> shift) & ((1u << take) - 1)) << done);
+					done += take;
+					bit += take;
+				}
+				words[i] = value;
+			}
+		}
+
+		// Most values that can be encoded, their bound does not overflow a size_t
+		template <typename T>
+		constexpr size_t max_packed_count = std::numeric_limits<size_t>::max() / (block_header_size<T> + sizeof(T));
+
+		// Largest encoded size of count values, at most max_packed_count
+		template <ePacking PACKING, typename T>
+		constexpr size_t packed_bound(size_t count) noexcept
+		{
+			return (count + pack_block - 1) / pack_block * block_header_size<T> + count * sizeof(T);
+		}
+
+		// Encode values into out, returns the bytes written, at most packed_bound
+		template <ePacking PACKING, typename T>
+		constexpr size_t pack_values(T const* values, size_t count, std::byte* out) noexcept
+		{
+			using W = pack_word_t<T>;
+
+			std::array<W, pack_block> words;
+			size_t size{};
+
+			for (size_t first = 0; first < count; first += pack_block)
+			{
+				size_t const n = std::min(pack_block, count - first);
+				T const* const block = values + first;
+
+				T const reference = PACKING == ePacking::delta ? block[0] : *std::min_element(block, block + n);
+
+				encode_values<PACKING>(block, n, reference, words.data());
+
+				W used{};
+				for (size_t i = 0; i < n; ++i)
+					used |= words[i];
+				unsigned const width = unsigned(std::bit_width(used));
+
+				out[size] = std::byte(width);
+				store_le(reference, out + size + 1);
+				size += block_header_size<T>;
+
+				pack_words(words.data(), n, width, out + size);
+				size += packed_size(n, width);
+			}
+
+			return size;
+		}
+
+		// Decode count values from bytes, false when they are not exactly the encoded values
+		template <ePacking PACKING, typename T>
+		constexpr bool unpack_values(std::span<std::byte const> bytes, T* values, size_t count) noexcept
+		{
+			using W = pack_word_t<T>;
+
+			std::array<W, pack_block> words;
+			size_t position{};
+
+			for (size_t first = 0; first < count; first += pack_block)
+			{
+				size_t const n = std::min(pack_block, count - first);
+
+				if (bytes.size() - position < block_header_size<T>)
+					return false;
+
+				unsigned const width = unsigned(bytes[position]);
+				T const reference = load_le<T>(bytes.data() + position + 1);
+				position += block_header_size<T>;
+
+				if (width > sizeof(T) * 8 || bytes.size() - position < packed_size(n, width))
+					return false;
+
+				unpack_words(bytes.data() + position, n, width, words.data());
+				position += packed_size(n, width);
+
+				decode_values<PACKING>(words.data(), n, reference, values + first);
+			}
+
+			return position == bytes.size();
+		}
+
+		template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		bool parse_packed(Stream& stream, Object& object)
+		{
+			using Cont = typename std::remove_cv_t<Object>::container_type;
+			using T = typename Cont::value_type;
+			constexpr ePacking packing = std::remove_cv_t<Object>::packing;
+
+			if constexpr (W)
+			{
+				Cont const& cont = object;
+				size_t const count = std::size(cont);
+
+				std::vector<std::byte> bytes(packed_bound<packing, T>(count));
+				size_t const size = pack_values<packing>(std::data(cont), count, bytes.data());
+
+				if (!parse_length<WRITE, Format>(stream, count) || !parse_length<WRITE, Format>(stream, size))
+					return result_fail;
+
+				write_raw(stream, std::span{ bytes }.first(size));
+				return result_success;
+			}
+			else // R
+			{
+				Cont& cont = object;
+
+				size_t count{}, size{};
+				if (!parse_length<READ, Format>(stream, count) || !parse_length<READ, Format>(stream, size))
+					return result_fail;
+
+				// Every block has a header, checked before the container is resized to count
+				if (count > max_packed_count<T> || size / block_header_size<T> < (count + pack_block - 1) / pack_block || size > packed_bound<packing, T>(count))
+					return result_fail;
+
+				// Viewed in place when possible
+				std::vector<std::byte> copy;
+				std::span<std::byte const> bytes;
+				if constexpr (is_viewable_v<Stream>)
+					bytes = stream.view(size);
+				else
+				{
+					if (!read_growing(stream, copy, size))
+						return result_fail;
+					bytes = copy;
+				}
+
+				size_t const first = Format::reuse ? 0 : std::size(cont);
+				cont.resize(first + count);
+
+				return unpack_values<packing>(bytes, std::data(cont) + first, count);
+			}
+		}
+	}
+
+}
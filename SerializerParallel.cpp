@@ -0,0 +1,58 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerParallel.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+using serializer_helper::Layout;
+using serializer_helper::BasicLayout;
+using serializer_helper::ReuseFormat;
+using serializer_helper::Parallel;
+
+static_assert(
+	[]
+	{
+		// Chunks of 3, the last one short
+		Parallel<std::vector<std::string>, 3> names{ "zero", "one", "two", "three", "four", "five", "six" };
+
+		Serializer io(SerializerGrowth{});
+		using Message = Layout<Parallel<std::vector<std::string>, 3>, int>;
+		Message::Write(io, names, 7);
+
+		// Skipped over in one step
+		bool const viewed = Message::View{ io.queued() }.get<1>() == 7;
+
+		auto const [replica, after] = Message::Read(io);
+
+		return viewed && replica == names && after == 7 && io.size() == 0;
+	}
+	(),
+	"Parallel vector"
+);
+
+static_assert(
+	[]
+	{
+		Serializer io(SerializerGrowth{});
+
+		// Empty, and read into existing elements
+		Parallel<std::vector<int>, 2> none{}, existing{ 9, 9, 9 };
+		Layout<decltype(none)>::Write(io, none);
+		Layout<decltype(none)>::Write(io, Parallel<std::vector<int>, 2>{ 1, 2, 3 });
+
+		auto const [empty] = Layout<decltype(none)>::Read(io);
+		BasicLayout<ReuseFormat, decltype(none)>::Read(io, existing);
+
+		return empty.empty() && existing == std::vector<int>{ 1, 2, 3 };
+	}
+	(),
+	"Parallel empty and reuse"
+);
+
+// Parallel containers hash apart from plain ones
+static_assert(Layout<Parallel<std::vector<std::string>>>::fingerprint() != Layout<std::vector<std::string>>::fingerprint());
+static_assert(Layout<Parallel<std::set<std::string>>>::fingerprint() != Layout<std::set<std::string>>::fingerprint());
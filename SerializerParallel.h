@@ -0,0 +1,279 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <span>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <exception>
+#include <algorithm>
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerIostreamHelper.h"
+
+namespace serializer_helper
+{
+
+	//
+	// Container written and read in parallel
+	// Written as: count, elements per chunk, the byte size of every chunk (a vector<uint64_t>), and the chunks.
+	// Chunks of CHUNK elements are encoded into a Serializer each, by as many threads as the hardware runs,
+	// and decoded alike: resizable random access containers in place, others into a vector per chunk first.
+	// The encoded container is held in memory while writing, and while reading from a stream that cannot be viewed.
+	// Streams that reference written bytes, like GatherWriter, reference the chunks and are flushed after them.
+	// Single threaded during constant evaluation.
+	//
+	template <typename Cont, size_t CHUNK = 16 * 1024>
+	struct Parallel : Cont
+	{
+		static_assert(CHUNK != 0, "Chunks hold at least one element");
+
+		using container_type = Cont;
+
+		static constexpr size_t chunk_size = CHUNK;
+
+		using Cont::Cont;
+
+		constexpr Parallel() = default;
+
+		constexpr Parallel(Cont container)
+			: Cont(std::move(container))
+		{}
+	};
+
+	namespace detail
+	{
+
+		// Run task(0) to task(count - 1) on a pool of threads, each taking the next index until none are left
+		// False once a task returns false, exceptions of tasks are rethrown
+		template <typename Task>
+		bool run_threads(size_t count, Task const& task)
+		{
+			std::atomic<size_t> next{};
+			std::atomic<bool> success{ true };
+			std::exception_ptr error{};
+			std::mutex mutex{};
+
+			auto const worker = [&]
+			{
+				try
+				{
+					for (size_t index; success.load(std::memory_order_relaxed) && (index = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+						if (!task(index))
+							success = false;
+				}
+				catch (...)
+				{
+					std::lock_guard lock{ mutex };
+					if (!error)
+						error = std::current_exception();
+					success = false;
+				}
+			};
+
+			size_t const threads = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+			{
+				std::vector<std::jthread> pool;
+				pool.reserve(threads - 1);
+				for (size_t i = 1; i < threads; ++i)
+					pool.emplace_back(worker);
+
+				worker();
+			}
+
+			if (error)
+				std::rethrow_exception(error);
+
+			return success;
+		}
+
+		template <typename Task>
+		constexpr bool run_parallel(size_t count, Task const& task)
+		{
+			if (std::is_constant_evaluated() || count <= 1)
+			{
+				for (size_t index = 0; index < count; ++index)
+					if (!task(index))
+						return result_fail;
+				return result_success;
+			}
+
+			return run_threads(count, task);
+		}
+
+		template <bool W, typename Format, typename Object, typename Stream>
+#if defined(__cpp_lib_bit_cast)
+		constexpr
+#endif
+		bool parse_parallel(Stream& stream, Object& object)
+		{
+			using Cont = typename std::remove_cv_t<Object>::container_type;
+			using T = element_t<Cont>;
+			constexpr size_t chunk_size = std::remove_cv_t<Object>::chunk_size;
+
+			if constexpr (W)
+			{
+				Cont const& cont = object;
+
+				size_t const count = std::size(cont);
+				size_t const chunks = (count + chunk_size - 1) / chunk_size;
+
+				// First element of every chunk
+				std::vector<decltype(std::begin(cont))> starts;
+				starts.reserve(chunks);
+				for (auto it = std::begin(cont); starts.size() != chunks;)
+				{
+					starts.push_back(it);
+					if (starts.size() != chunks)
+						std::advance(it, chunk_size);
+				}
+
+				std::vector<Serializer<>> parts;
+				parts.reserve(chunks);
+				for (size_t i = 0; i < chunks; ++i)
+					parts.emplace_back(SerializerGrowth{});
+
+				bool const encoded = run_parallel(chunks, [&](size_t chunk)
+				{
+					auto it = starts[chunk];
+					for (size_t i = std::min(chunk_size, count - chunk * chunk_size); i != 0; --i, ++it)
+						if (!parse_object<WRITE, Format>(parts[chunk], *it))
+							return result_fail;
+					return result_success;
+				});
+
+				if (!encoded)
+					return result_fail;
+
+				std::vector<uint64_t> sizes;
+				sizes.reserve(chunks);
+				for (auto const& part : parts)
+					sizes.push_back(part.size());
+
+				uint64_t const elements{ chunk_size };
+				if (!parse_length<WRITE, Format>(stream, count) || !parse_object<WRITE, Format>(stream, elements) || !parse_object<WRITE, Format>(stream, std::as_const(sizes)))
+					return result_fail;
+
+				// The chunks are released on return
+				if constexpr (writes_referenced_v<Stream>)
+				{
+					for (auto const& part : parts)
+						stream.write_referenced(part.queued());
+					stream.flush();
+				}
+				else
+					for (auto const& part : parts)
+						write_raw(stream, part.queued());
+
+				return result_success;
+			}
+			else // R
+			{
+				Cont& cont = object;
+
+				size_t count{}, chunks{};
+				uint64_t elements{};
+				if (!parse_length<READ, Format>(stream, count) || !parse_object<READ, Format>(stream, elements) || !parse_length<READ, Format>(stream, chunks))
+					return result_fail;
+
+				// The table has a size per chunk, checked before it is read
+				if (count == 0 ? chunks != 0 : elements == 0 || chunks != (count - 1) / elements + 1)
+					return result_fail;
+
+				std::vector<uint64_t> sizes;
+				if (!read_values<Format>(stream, sizes, chunks))
+					return result_fail;
+
+				// A corrupt table fails when its sizes wrap around or exceed the stream
+				std::vector<uint64_t> offsets(chunks + 1);
+				for (size_t i = 0; i < chunks; ++i)
+				{
+					if (sizes[i] > std::numeric_limits<size_t>::max() - offsets[i])
+						return result_fail;
+					offsets[i + 1] = offsets[i] + sizes[i];
+				}
+
+				size_t const total = size_t(offsets.back());
+				if constexpr (is_viewable_v<Stream> && requires { stream.size(); })
+					if (total > size_t(stream.size()))
+						return result_fail;
+
+				// Every element takes a byte at least, a corrupt count fails before the container is resized
+				if (count > total)
+					return result_fail;
+
+				// Viewed in place when possible
+				std::vector<std::byte> copy;
+				std::span<std::byte const> bytes;
+				if constexpr (is_viewable_v<Stream>)
+					bytes = stream.view(total);
+				else
+				{
+					if (!read_growing(stream, copy, total))
+						return result_fail;
+					bytes = copy;
+				}
+
+				// Decode each element of a chunk, which must use up its bytes
+				auto const decode = [&](size_t chunk, auto&& element)
+				{
+					ByteReader reader{ bytes.subspan(size_t(offsets[chunk]), size_t(sizes[chunk])) };
+					size_t const first = chunk * size_t(elements);
+					for (size_t i = first, last = std::min(count, first + size_t(elements)); i != last; ++i)
+						if (!parse_object<READ, Format>(reader, element(i - first)))
+							return result_fail;
+					return uint64_t(reader.tellg()) == sizes[chunk];
+				};
+
+				if constexpr (requires (size_t i) { cont.resize(i); { cont[i] } -> std::same_as<T&>; })
+				{
+					size_t const first = Format::reuse ? 0 : std::size(cont);
+					cont.resize(first + count);
+
+					return run_parallel(chunks, [&](size_t chunk)
+					{
+						size_t const start = first + chunk * size_t(elements);
+						return decode(chunk, [&](size_t i) -> T& { return cont[start + i]; });
+					});
+				}
+				else
+				{
+					std::vector<std::vector<value_t<T>>> decoded(chunks);
+
+					bool const success = run_parallel(chunks, [&](size_t chunk)
+					{
+						auto& values = decoded[chunk];
+						size_t const first = chunk * size_t(elements);
+						values.reserve(std::min(count, first + size_t(elements)) - first);
+						for (size_t i = first, last = std::min(count, first + size_t(elements)); i != last; ++i)
+							values.push_back(make_element<value_t<T>>(cont));
+
+						return decode(chunk, [&](size_t i) -> value_t<T>& { return values[i]; });
+					});
+
+					if (!success)
+						return result_fail;
+
+					if constexpr (Format::reuse)
+						cont.clear();
+
+					auto inserter = std::inserter(cont, std::end(cont));
+					for (auto& values : decoded)
+						for (auto& value : values)
+							inserter = std::move(value);
+
+					return result_success;
+				}
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,215 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <bit>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <array>
+
+#include "ConstexprSerializerBuffer.h"
+
+// Amount of threads writing to a SerializerQueue
+enum class eProducers
+{
+	single,
+	multiple
+};
+
+// Lock-free queue of serialized frames in a circular buffer of CAPACITY bytes
+// Producers reserve a slot, write into it in place and publish it with a single release store.
+// The (single) consumer reads published frames in place and pops them.
+// A single producer publishes by advancing the write position, multiple producers claim space
+// with a compare-exchange and publish the frame's header, which lets them publish out of order.
+// A single producer must publish a slot before reserving the next one.
+// An unpublished slot holds back every frame after it.
+// Frames do not wrap around the end of the buffer, a padding frame fills it first. Frames of up to half the capacity
+// always fit an empty queue, larger ones may wait for the consumer to pass that padding.
+template <size_t CAPACITY, eProducers PRODUCERS = eProducers::single>
+class SerializerQueue
+{
+	static_assert(std::has_single_bit(CAPACITY) && CAPACITY >= 64, "Capacity must be a power of two of at least 64 bytes");
+	static_assert(CAPACITY <= 0x8000'0000, "Frame sizes are stored in 32 bits");
+
+	// Frame header: frame size in the low half (0 until published), payload length in the high half
+	using Header = uint64_t;
+
+	static constexpr uint64_t padding = 0xFFFF'FFFF;
+
+public:
+
+	// Frame reserved by a producer, write into it and publish it
+	class Slot : private detail::SerializerBase
+	{
+	public:
+
+		using SerializerBase::write;
+		using SerializerBase::size;
+		using SerializerBase::prepare;
+		using SerializerBase::commit;
+
+	private:
+
+		friend SerializerQueue;
+
+		Slot(std::span<std::byte> payload, uint64_t position, uint64_t frame)
+			: SerializerBase{ payload }
+			, m_Position{ position }
+			, m_Frame{ frame }
+		{}
+
+		// Position of the header and size of the frame
+		uint64_t m_Position, m_Frame;
+	};
+
+	// Published frame, read it in place and pop it
+	class Frame : private detail::SerializerBase
+	{
+	public:
+
+		using SerializerBase::read;
+		using SerializerBase::view;
+		using SerializerBase::size;
+		using SerializerBase::queued;
+
+	private:
+
+		friend SerializerQueue;
+
+		explicit Frame(std::span<std::byte> payload)
+		{
+			reset_buffer(payload);
+			commit(payload.size());
+		}
+	};
+
+	SerializerQueue() = default;
+
+	SerializerQueue(SerializerQueue const&) = delete;
+	SerializerQueue& operator = (SerializerQueue const&) = delete;
+
+
+	// Reserve a slot for up to size bytes, empty when the queue is too full
+	std::optional<Slot> try_reserve(size_t size)
+	{
+		uint64_t const frame = frame_size(size);
+		if (frame > CAPACITY)
+			throw std::length_error{ "Frame larger than the queue" };
+
+		uint64_t head = m_Head.load(std::memory_order_relaxed);
+		while (true)
+		{
+			// Frames do not wrap, a padding frame of its own fills the end of the buffer first
+			uint64_t const position = head % CAPACITY;
+			uint64_t const reserved = position + frame > CAPACITY
+				? CAPACITY - position
+				: frame;
+
+			if (head + reserved - m_Tail.load(std::memory_order_acquire) > CAPACITY)
+				return std::nullopt;
+
+			if constexpr (PRODUCERS == eProducers::multiple)
+				if (!m_Head.compare_exchange_weak(head, head + reserved, std::memory_order_relaxed))
+					continue;
+
+			if (reserved == frame)
+				return Slot{ payload(position, frame - sizeof(Header)), position, frame };
+
+			// Published right away, then the frame is reserved from the start of the buffer
+			publish_header(position, (padding << 32) | reserved);
+			head += reserved;
+
+			if constexpr (PRODUCERS == eProducers::single)
+				m_Head.store(head, std::memory_order_release);
+		}
+	}
+
+	// Publish a slot with the bytes written into it
+	void publish(Slot& slot)
+	{
+		publish_header(slot.m_Position, (uint64_t(slot.size()) << 32) | slot.m_Frame);
+
+		if constexpr (PRODUCERS == eProducers::single)
+			m_Head.store(m_Head.load(std::memory_order_relaxed) + slot.m_Frame, std::memory_order_release);
+	}
+
+
+	// Oldest published frame, empty if there is none
+	std::optional<Frame> try_front()
+	{
+		while (true)
+		{
+			uint64_t const position = m_Tail.load(std::memory_order_relaxed) % CAPACITY;
+
+			if constexpr (PRODUCERS == eProducers::single)
+				if (m_Tail.load(std::memory_order_relaxed) == m_Head.load(std::memory_order_acquire))
+					return std::nullopt;
+
+			Header const header = load_header(position);
+			if (header == 0)
+				return std::nullopt;
+
+			m_Front = header & 0xFFFF'FFFF;
+
+			if ((header >> 32) != padding)
+				return Frame{ payload(position, header >> 32) };
+
+			pop();
+		}
+	}
+
+	// Pop the frame returned by try_front
+	void pop()
+	{
+		uint64_t const tail = m_Tail.load(std::memory_order_relaxed);
+
+		// Unpublished headers must read as 0
+		if constexpr (PRODUCERS == eProducers::multiple)
+			std::memset(bytes() + tail % CAPACITY, 0, m_Front);
+
+		m_Tail.store(tail + m_Front, std::memory_order_release);
+		m_Front = 0;
+	}
+
+private:
+
+	static constexpr uint64_t frame_size(size_t payload) noexcept
+	{
+		// Headers stay aligned
+		return (sizeof(Header) + payload + alignof(Header) - 1) / alignof(Header) * alignof(Header);
+	}
+
+	std::byte* bytes() noexcept
+	{
+		return reinterpret_cast<std::byte*>(m_Buffer.data());
+	}
+
+	std::span<std::byte> payload(uint64_t position, uint64_t size) noexcept
+	{
+		return { bytes() + position + sizeof(Header), size_t(size) };
+	}
+
+	void publish_header(uint64_t position, Header header) noexcept
+	{
+		std::atomic_ref<Header>{ m_Buffer[position / sizeof(Header)] }.store(header, std::memory_order_release);
+	}
+
+	Header load_header(uint64_t position) noexcept
+	{
+		return std::atomic_ref<Header>{ m_Buffer[position / sizeof(Header)] }.load(std::memory_order_acquire);
+	}
+
+	// Write position, shared by producers
+	alignas(64) std::atomic<uint64_t> m_Head{};
+
+	// Read position, owned by the consumer
+	alignas(64) std::atomic<uint64_t> m_Tail{};
+	uint64_t m_Front{};
+
+	alignas(64) std::array<Header, CAPACITY / sizeof(Header)> m_Buffer{};
+
+};
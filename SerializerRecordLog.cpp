@@ -0,0 +1,72 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerRecordLog.h"
+
+#include <string>
+#include <vector>
+#include <iterator>
+
+using serializer_helper::Layout;
+using serializer_helper::Record;
+using serializer_helper::RecordLogView;
+using serializer_helper::RecordLogWriter;
+using serializer_helper::eRecordCheck;
+
+static_assert(
+	[]
+	{
+		using Entry = Layout<std::string, int>;
+
+		Serializer io(SerializerGrowth{});
+		RecordLogWriter log{ io };
+		log.append<Entry>(std::string{ "open" }, 1);
+		uint64_t const second = log.append<Entry>(std::string{ "write" }, 2);
+		log.append<Entry>(std::string{ "close" }, 3);
+
+		RecordLogView const view{ io.queued() };
+
+		// Payloads decoded in place
+		std::vector<int> values;
+		for (Record const& record : view)
+			values.push_back(Entry::View{ record.payload }.get<1>());
+
+		return values == std::vector<int>{ 1, 2, 3 }
+			&& Entry::View{ view.at(second)->payload }.get<0>() == "write"
+			&& Entry::View{ view.last()->payload }.get<0>() == "close"
+			&& view.valid_size() == io.size() && log.size() == io.size();
+	}
+	(),
+	"Record log"
+);
+
+static_assert(
+	[]
+	{
+		using Entry = Layout<std::string>;
+
+		Serializer io(SerializerGrowth{});
+		RecordLogWriter log{ io };
+		log.append<Entry>(std::string{ "first" });
+		uint64_t const damaged = log.append<Entry>(std::string{ "second" });
+		uint64_t const third = log.append<Entry>(std::string{ "third" });
+		uint64_t const torn = log.append<Entry>(std::string{ "torn" });
+
+		std::vector<std::byte> bytes{ io.queued().begin(), io.queued().end() };
+
+		// A damaged payload, and a last frame cut off by a crash
+		bytes[size_t(damaged) + 20] ^= std::byte{ 1 };
+		bytes.resize(bytes.size() - 2);
+
+		RecordLogView const checked{ bytes };
+		RecordLogView const stepped{ bytes, eRecordCheck::length };
+
+		// Checksums skip the damaged frame, lengths only catch the torn one
+		return std::ranges::distance(checked) == 2 && std::ranges::distance(stepped) == 3
+			&& checked.find(damaged).offset == third
+			&& checked.valid_size() == torn && stepped.valid_size() == torn;
+	}
+	(),
+	"Record log recovery"
+);
@@ -0,0 +1,274 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerIostreamHelper.h"
+#include "SerializerChecksum.h"
+
+namespace serializer_helper
+{
+
+	namespace detail
+	{
+		// Frame header: sync marker, payload size, and CRC32C of the size and payload, 4 bytes little endian each
+		constexpr size_t record_header_size = 12;
+
+		constexpr std::array<std::byte, 4> record_marker{ std::byte(0x7E), std::byte(0x5A), std::byte(0xC3), std::byte(0x81) };
+
+		constexpr uint32_t load_u32(std::span<std::byte const, 4> bytes) noexcept
+		{
+			return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+		}
+
+		constexpr void store_u32(std::span<std::byte, 4> bytes, uint32_t value) noexcept
+		{
+			for (size_t i = 0; i < 4; ++i)
+				bytes[i] = std::byte(value >> (i * 8));
+		}
+	}
+
+	// How a frame is found valid
+	enum class eRecordCheck
+	{
+		// Marker, size, and checksum of the payload
+		checksum,
+		// Marker and size only, steps from frame to frame without reading payloads
+		length
+	};
+
+	// Record found in a log, the payload is not copied
+	struct Record
+	{
+		// Offset of the frame in the log
+		uint64_t offset;
+
+		std::span<std::byte const> payload;
+
+		// Offset of the next frame
+		constexpr uint64_t end() const noexcept
+		{
+			return offset + detail::record_header_size + payload.size();
+		}
+	};
+
+	//
+	// Writer of an append-only record log
+	// Every record is framed with a sync marker, its size and a CRC32C, so readers find record boundaries
+	// without decoding, and recover after a crash from a torn last frame or damaged frames.
+	// offset is the size of the log appended to, see RecordLogView::valid_size().
+	//
+	template <typename Stream>
+	class RecordLogWriter
+	{
+	public:
+
+		constexpr explicit RecordLogWriter(Stream& stream, uint64_t offset = 0)
+			: m_Stream{ stream }
+			, m_Offset{ offset }
+			, m_Record(SerializerGrowth{})
+		{}
+
+		RecordLogWriter(RecordLogWriter const&) = delete;
+		RecordLogWriter& operator = (RecordLogWriter const&) = delete;
+
+		// Append objects written with a layout as one record, returns the offset of its frame
+		template <typename RecordLayout, typename ... Objects>
+		constexpr uint64_t append(Objects const& ... objects)
+		{
+			m_Record.clear();
+			RecordLayout::Write(m_Record, objects...);
+			return append(m_Record.queued());
+		}
+		//
+		// Append bytes as one record, returns the offset of its frame
+		constexpr uint64_t append(std::span<std::byte const> payload)
+		{
+			if (payload.size() > UINT32_MAX)
+				throw std::length_error{ "Record too large" };
+
+			std::array<std::byte, detail::record_header_size> header{};
+			std::ranges::copy(detail::record_marker, header.begin());
+			detail::store_u32(std::span{ header }.subspan<4, 4>(), uint32_t(payload.size()));
+			detail::store_u32(std::span{ header }.subspan<8, 4>(), crc32c(payload, crc32c(std::span{ header }.subspan<4, 4>())));
+
+			if (!detail::put_bytes(m_Stream, header) || !detail::put_bytes(m_Stream, payload))
+				fail();
+
+			return std::exchange(m_Offset, m_Offset + header.size() + payload.size());
+		}
+
+		// Size of the log
+		constexpr uint64_t size() const noexcept
+		{
+			return m_Offset;
+		}
+
+	private:
+
+		constexpr void fail()
+		{
+			if constexpr (detail::has_streambuf_v<Stream>)
+				m_Stream.setstate(std::ios_base::failbit);
+			else
+				throw std::runtime_error{ "Record log failed" };
+		}
+
+		Stream& m_Stream;
+
+		uint64_t m_Offset;
+
+		// Record being written
+		Serializer<> m_Record;
+
+	};
+
+	//
+	// Records of a log in bytes, for example of a MappedSerializer
+	// Iterates the valid frames without copying their payloads, decode them with Layout<...>::View or Read.
+	// A damaged frame is skipped by searching for the next sync marker, a torn last frame ends the log.
+	//
+	class RecordLogView
+	{
+	public:
+
+		class iterator
+		{
+		public:
+
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Record;
+			using difference_type = std::ptrdiff_t;
+			using pointer = Record const*;
+			using reference = Record const&;
+
+			constexpr iterator() = default;
+
+			constexpr iterator(RecordLogView const* log, Record record) noexcept
+				: m_Log{ log }
+				, m_Record{ record }
+			{}
+
+			constexpr reference operator * () const noexcept
+			{
+				return m_Record;
+			}
+
+			constexpr pointer operator -> () const noexcept
+			{
+				return &m_Record;
+			}
+
+			constexpr iterator& operator ++ ()
+			{
+				m_Record = m_Log->find(m_Record.end());
+				return *this;
+			}
+
+			constexpr iterator operator ++ (int)
+			{
+				iterator copy = *this;
+				++*this;
+				return copy;
+			}
+
+			constexpr bool operator == (iterator const& other) const noexcept
+			{
+				return m_Record.offset == other.m_Record.offset;
+			}
+
+		private:
+
+			RecordLogView const* m_Log{};
+
+			Record m_Record{};
+
+		};
+
+		constexpr explicit RecordLogView(std::span<std::byte const> bytes, eRecordCheck check = eRecordCheck::checksum) noexcept
+			: m_Bytes{ bytes }
+			, m_Check{ check }
+		{}
+
+		constexpr iterator begin() const
+		{
+			return { this, find(0) };
+		}
+
+		constexpr iterator end() const noexcept
+		{
+			return { this, { m_Bytes.size(), {} } };
+		}
+
+		// Valid frame at offset
+		constexpr std::optional<Record> at(uint64_t offset) const
+		{
+			if (offset > m_Bytes.size() || m_Bytes.size() - offset < detail::record_header_size)
+				return std::nullopt;
+
+			auto const header = m_Bytes.subspan(size_t(offset)).first<detail::record_header_size>();
+			if (!std::ranges::equal(header.first<4>(), detail::record_marker))
+				return std::nullopt;
+
+			size_t const size = detail::load_u32(header.subspan<4, 4>());
+			if (size > m_Bytes.size() - offset - header.size())
+				return std::nullopt;
+
+			auto const payload = m_Bytes.subspan(size_t(offset) + header.size(), size);
+			if (m_Check == eRecordCheck::checksum && crc32c(payload, crc32c(header.subspan<4, 4>())) != detail::load_u32(header.subspan<8, 4>()))
+				return std::nullopt;
+
+			return Record{ offset, payload };
+		}
+
+		// First valid frame at or after offset, end() if there is none
+		constexpr Record find(uint64_t offset) const
+		{
+			while (offset < m_Bytes.size())
+			{
+				if (auto const record = at(offset))
+					return *record;
+
+				// Resynchronize on the next marker
+				auto const rest = m_Bytes.subspan(size_t(offset) + 1);
+				offset = uint64_t(std::ranges::search(rest, detail::record_marker).begin() - m_Bytes.begin());
+			}
+			return { m_Bytes.size(), {} };
+		}
+
+		// Last valid frame, steps over the frames without decoding them
+		constexpr std::optional<Record> last() const
+		{
+			std::optional<Record> last{};
+			for (Record const& record : *this)
+				last = record;
+			return last;
+		}
+
+		// Bytes up to the end of the last valid frame, truncate the log to it before appending after a crash
+		constexpr uint64_t valid_size() const
+		{
+			auto const record = last();
+			return record ? record->end() : 0;
+		}
+
+	private:
+
+		std::span<std::byte const> m_Bytes;
+
+		eRecordCheck m_Check;
+
+	};
+
+}
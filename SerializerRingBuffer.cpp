@@ -0,0 +1,74 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#include "SerializerRingBuffer.h"
+#include "SerializerIostreamHelper.h"
+
+static_assert(
+	[]
+	{
+		RingSerializer<8> io{};
+
+		io.write(short(1));
+		io.write(short(2));
+		io.write(short(3));
+		io.read<short>();
+		io.read<short>();
+
+		// Straddles the end
+		io.write(27);
+
+		return io.read<short>() == 3
+			&& io.read<int>() == 27
+			&& io.size() == 0;
+	}
+	(),
+	"Values wrapping around"
+);
+
+static_assert(
+	[]
+	{
+		RingSerializer<6> io{};
+		io.write(std::array<char, 4>{ 'a', 'b', 'c', 'd' });
+		io.read<std::array<char, 3>>();
+
+		// Direct access to the regions
+		auto const [first, second] = io.free_regions();
+		first[0] = std::byte{ 'e' };
+		first[1] = std::byte{ 'f' };
+		second[0] = std::byte{ 'g' };
+		io.commit(first.size() + 1);
+
+		auto const [queued, wrapped] = io.queued_regions();
+		bool const split = queued.size() == 3 && wrapped.size() == 1;
+		io.consume(1);
+
+		return split && io.read<std::array<char, 3>>() == std::array<char, 3>{ 'e', 'f', 'g' };
+	}
+	(),
+	"Wrapping regions"
+);
+
+static_assert(
+	[]
+	{
+		using serializer_helper::Layout;
+		using MyLayout = Layout<std::string, int>;
+
+		RingSerializer<32> io{};
+
+		// Records keep streaming through the same buffer
+		for (int i = 0; i < 16; ++i)
+		{
+			MyLayout::Write(io, "Hello", i);
+
+			auto const [str, value] = MyLayout::Read(io);
+			if (str != "Hello" || value != i)
+				return false;
+		}
+		return io.size() == 0;
+	}
+	(),
+	"Streaming records"
+);
@@ -0,0 +1,272 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+#pragma once
+
+#include <bit>
+#include <span>
+#include <array>
+#include <ranges>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+// Fixed size circular buffer with the Serializer interface
+// Free and queued regions wrap around the end of the buffer, values may straddle it.
+// Reading frees bytes for writing without clearing or compacting.
+template <size_t EXTENT>
+class RingSerializer
+{
+
+	// Byte array alias
+	template <typename Val>
+	using Bytes = std::array<std::byte, sizeof(Val)>;
+
+	// Up to two regions, the second one starting at the front of the buffer
+	template <typename Byte>
+	using Regions = std::array<std::span<Byte>, 2>;
+
+public:
+
+	constexpr RingSerializer() = default;
+
+
+	// Write memory (iostream alike)
+	constexpr RingSerializer& write(char const* src, std::streamsize count)
+	{
+		require_free(size_t(count));
+
+		if (std::is_constant_evaluated())
+			for (std::streamsize i = 0; i < count; ++i)
+				write(src[i]);
+		else
+			copy_in(std::as_bytes(std::span{ src, size_t(count) }));
+
+		return *this;
+	}
+	//
+	// Read memory (iostream alike)
+	constexpr RingSerializer& read(char* dest, std::streamsize count)
+	{
+		require_queued(size_t(count));
+
+		if (std::is_constant_evaluated())
+			for (std::streamsize i = 0; i < count; ++i)
+				read(dest[i]);
+		else
+			copy_out(std::as_writable_bytes(std::span{ dest, size_t(count) }));
+
+		return *this;
+	}
+
+
+	// Write value
+	template <typename Val> requires std::is_trivially_copyable_v<Val>
+	constexpr RingSerializer& write(Val const& value)
+	{
+		require_free(sizeof(Val));
+
+		auto const bytes = std::bit_cast<Bytes<Val>>(value); // reinterpret_cast
+		copy_in(bytes);
+
+		return *this;
+	}
+	//
+	// Read value
+	template <typename Val> requires std::is_trivially_copyable_v<Val>
+	constexpr Val read()
+	{
+		require_queued(sizeof(Val));
+
+		Bytes<Val> bytes{};
+		copy_out(bytes);
+		return std::bit_cast<Val>(bytes);
+	}
+	//
+	// Read value (into memory)
+	template <typename Val> requires std::is_trivially_copyable_v<Val>
+	constexpr RingSerializer& read(Val& value)
+	{
+		value = read<Val>();
+
+		return *this;
+	}
+
+
+	// Write values (ranges range)
+	template <std::ranges::sized_range Source, typename Value = std::ranges::range_value_t<Source>> requires std::is_trivially_copyable_v<Value>
+	constexpr RingSerializer& write(Source&& source)
+	{
+		require_free(std::ranges::size(source) * sizeof(Value));
+
+		// Contiguous memory can be copied at once outside of constant evaluation
+		if constexpr (std::ranges::contiguous_range<Source>)
+			if (!std::is_constant_evaluated())
+			{
+				copy_in(std::as_bytes(std::span{ std::ranges::data(source), std::ranges::size(source) }));
+				return *this;
+			}
+
+		for (auto& value : source)
+			write(value);
+
+		return *this;
+	}
+	//
+	// Read values (ranges range)
+	template <std::ranges::sized_range Dst, typename Value = std::ranges::range_value_t<Dst>> requires std::is_trivially_copyable_v<Value>
+	constexpr RingSerializer& read(Dst&& dest)
+	{
+		require_queued(std::ranges::size(dest) * sizeof(Value));
+
+		// Contiguous memory can be copied at once outside of constant evaluation
+		if constexpr (std::ranges::contiguous_range<Dst> && !std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<Dst>>>)
+			if (!std::is_constant_evaluated())
+			{
+				copy_out(std::as_writable_bytes(std::span{ std::ranges::data(dest), std::ranges::size(dest) }));
+				return *this;
+			}
+
+		for (auto& value : dest)
+			read(value);
+
+		return *this;
+	}
+
+
+	// Free memory, to write into directly (e.g. receive from a socket)
+	// Bytes written into it are queued by commit
+	constexpr Regions<std::byte> free_regions() noexcept
+	{
+		return regions<std::byte>(m_Tail, EXTENT - m_Size);
+	}
+	//
+	// Queue count bytes written into the free regions
+	constexpr RingSerializer& commit(size_t count)
+	{
+		require_free(count);
+
+		m_Tail = wrap(m_Tail + count);
+		m_Size += count;
+
+		return *this;
+	}
+
+	// Queued memory, to read from directly
+	// Bytes read from it are freed by consume
+	constexpr Regions<std::byte const> queued_regions() const noexcept
+	{
+		return regions<std::byte const>(m_Head, m_Size);
+	}
+	//
+	// Free count bytes read from the queued regions
+	constexpr RingSerializer& consume(size_t count)
+	{
+		require_queued(count);
+
+		m_Head = wrap(m_Head + count);
+		m_Size -= count;
+
+		return *this;
+	}
+
+
+	// Amount of bytes queued for reading
+	constexpr size_t size() const noexcept
+	{
+		return m_Size;
+	}
+
+	// Buffer size
+	constexpr size_t capacity() const noexcept
+	{
+		return EXTENT;
+	}
+
+	// Clear buffer
+	constexpr void clear() noexcept
+	{
+		m_Head = m_Tail = m_Size = 0;
+	}
+
+private:
+
+	static constexpr size_t wrap(size_t index) noexcept
+	{
+		return index >= EXTENT ? index - EXTENT : index;
+	}
+
+	template <typename Byte>
+	constexpr Regions<Byte> regions(size_t begin, size_t count) const noexcept
+	{
+		auto const data = const_cast<std::byte*>(m_Array.data());
+
+		size_t const first = std::min(count, EXTENT - begin);
+		return { 
+			std::span<Byte>{ data + begin, first },
+			std::span<Byte>{ data, count - first }
+		};
+	}
+
+	constexpr void require_free(size_t count) const
+	{
+		if (count > EXTENT - m_Size)
+			throw std::runtime_error{ "Buffer overflow" };
+	}
+
+	constexpr void require_queued(size_t count) const
+	{
+		if (count > m_Size)
+			throw std::runtime_error{ "Buffer holds too little data" };
+	}
+
+	// Copy into the free regions and queue, bytes must fit
+	constexpr void copy_in(std::span<std::byte const> bytes)
+	{
+		auto const [first, second] = free_regions();
+		size_t const split = std::min(bytes.size(), first.size());
+
+		if (std::is_constant_evaluated())
+		{
+			std::ranges::copy(bytes.first(split), first.begin());
+			std::ranges::copy(bytes.subspan(split), second.begin());
+		}
+		else if (!bytes.empty())
+		{
+			std::memcpy(first.data(), bytes.data(), split);
+			std::memcpy(second.data(), bytes.data() + split, bytes.size() - split);
+		}
+
+		commit(bytes.size());
+	}
+
+	// Copy out of the queued regions and free, bytes must be queued
+	constexpr void copy_out(std::span<std::byte> bytes)
+	{
+		auto const [first, second] = queued_regions();
+		size_t const split = std::min(bytes.size(), first.size());
+
+		if (std::is_constant_evaluated())
+		{
+			std::ranges::copy(first.first(split), bytes.begin());
+			std::ranges::copy(second.first(bytes.size() - split), bytes.begin() + split);
+		}
+		else if (!bytes.empty())
+		{
+			std::memcpy(bytes.data(), first.data(), split);
+			std::memcpy(bytes.data() + split, second.data(), bytes.size() - split);
+		}
+
+		consume(bytes.size());
+	}
+
+	// Buffer
+	std::array<std::byte, EXTENT> m_Array{};
+
+	// Queued region
+	size_t m_Head{}, m_Size{};
+
+	// Start of the free region
+	size_t m_Tail{};
+
+};
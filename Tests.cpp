@@ -0,0 +1,674 @@
+// Copyright (c) Kobe Vrijsen 2022
+// Licensed under the EUPL-1.2-or-later
+
+// Run time tests of what static_asserts can not reach: files, descriptors, threads and reads that throw
+// Usage: Tests
+
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_set>
+
+#include "ConstexprSerializerBuffer.h"
+#include "SerializerIostreamHelper.h"
+#include "SerializerCompression.h"
+#include "SerializerChecksum.h"
+#include "SerializerGather.h"
+#include "SerializerParallel.h"
+#include "SerializerPacked.h"
+#include "SerializerIndexed.h"
+#include "SerializerAsyncFile.h"
+#include "SerializerMappedFile.h"
+#include "SerializerQueue.h"
+
+using serializer_helper::Layout;
+using serializer_helper::BasicLayout;
+using serializer_helper::ReuseFormat;
+
+namespace
+{
+
+	void expect(bool condition, std::string_view what)
+	{
+		if (!condition)
+		{
+			std::fprintf(stderr, "Failed: %s\n", what.data());
+			std::exit(EXIT_FAILURE);
+		}
+	}
+
+	// File in the temporary directory, removed when done
+	struct TempFile
+	{
+		std::filesystem::path path = std::filesystem::temp_directory_path() / "ConstexprSerializerTests.bin";
+
+		~TempFile()
+		{
+			std::error_code error;
+			std::filesystem::remove(path, error);
+		}
+	};
+
+	// Open descriptors of the process, where they can be counted
+	size_t open_files()
+	{
+#if defined(__linux__)
+		return size_t(std::distance(std::filesystem::directory_iterator{ "/proc/self/fd" }, {}));
+#else
+		return 0;
+#endif
+	}
+
+	void mapped_file()
+	{
+		TempFile const file;
+
+		using Entry = Layout<std::string, std::vector<uint32_t>, double>;
+		std::vector<uint32_t> const values{ 1, 2, 3, 0xDEADBEEF };
+
+		// Created larger than needed, truncated to the written bytes when closed
+		size_t written{};
+		{
+			MappedSerializer out{ file.path, 4096 };
+			Entry::Write(out, std::string{ "mapped" }, values, 2.5);
+			Entry::Write(out, std::string{ "twice" }, std::vector<uint32_t>{}, -1.);
+			written = out.size();
+			out.flush();
+		}
+		expect(std::filesystem::file_size(file.path) == written, "Mapped file truncated to the written bytes");
+
+		{
+			MappedSerializer in{ file.path };
+			in.advise(MappedSerializer::eAdvice::sequential);
+
+			auto const [name, read, value] = Entry::Read(in);
+			auto const [name2, read2, value2] = Entry::Read(in);
+			expect(name == "mapped" && read == values && value == 2.5, "Mapped file first entry");
+			expect(name2 == "twice" && read2.empty() && value2 == -1., "Mapped file second entry");
+			expect(in.size() == 0, "Mapped file read whole");
+		}
+
+		// Failing to size the file closes it again
+		size_t const before = open_files();
+		bool threw = false;
+		try
+		{
+			MappedSerializer out{ file.path, size_t(-1) };
+		}
+		catch (std::system_error const&)
+		{
+			threw = true;
+		}
+		expect(threw && open_files() == before, "Mapped file closed when mapping fails");
+	}
+
+	// Reading fails with the error of the stream, not by allocating for a corrupt count
+	template <typename Read>
+	bool fails_to_read(Read read)
+	{
+		try
+		{
+			read();
+		}
+		catch (std::runtime_error const&)
+		{
+			return true;
+		}
+		return false;
+	}
+
+	void corrupt_counts()
+	{
+		// A count of 2^60 followed by one short string
+		Serializer corrupt(SerializerGrowth{});
+		corrupt.write(uint64_t{ 1 } << 60);
+		Layout<std::string>::Write(corrupt, std::string{ "only" });
+
+		auto const fails = [&corrupt](auto read)
+		{
+			Serializer io(SerializerGrowth{});
+			io.write(corrupt.queued());
+			return fails_to_read([&] { read(io); });
+		};
+
+		expect(fails([](auto& io) { Layout<std::vector<std::string>>::Read(io); }), "Corrupt count of a vector");
+		expect(fails([](auto& io) { Layout<std::unordered_set<std::string>>::Read(io); }), "Corrupt count of an unordered set");
+
+		std::vector<std::string> existing{ "a", "b" };
+		expect(fails([&](auto& io) { BasicLayout<ReuseFormat, std::vector<std::string>>::Read(io, existing); }), "Corrupt count of a reused vector");
+		std::unordered_set<std::string> set{ "a" };
+		expect(fails([&](auto& io) { BasicLayout<ReuseFormat, std::unordered_set<std::string>>::Read(io, set); }), "Corrupt count of a reused set");
+
+		// A count of 2^33 values in front of 8 bytes, from a buffer and from an iostream
+		Serializer values(SerializerGrowth{});
+		values.write(uint64_t{ 1 } << 33);
+		values.write(uint64_t{ 42 });
+		std::string const bytes{ reinterpret_cast<char const*>(values.queued().data()), values.queued().size() };
+
+		auto const fails_both = [&](auto read)
+		{
+			Serializer io(SerializerGrowth{});
+			io.write(values.queued());
+			std::stringstream is{ bytes };
+			return fails_to_read([&] { read(io); }) && fails_to_read([&] { read(is); });
+		};
+
+		expect(fails_both([](auto& io) { Layout<std::vector<uint32_t>>::Read(io); }), "Corrupt count of a vector of values");
+		expect(fails_both([](auto& io) { Layout<std::string>::Read(io); }), "Corrupt length of a string");
+
+		// A count with nothing after it
+		Serializer empty(SerializerGrowth{});
+		empty.write(uint64_t{ 5 });
+		expect(fails_to_read([&] { Layout<std::vector<uint32_t>>::Read(empty); }), "Count of values without them");
+
+		// Values past the first part of an iostream
+		std::vector<uint32_t> many(200'000);
+		for (uint32_t i = 0; i < many.size(); ++i)
+			many[i] = i;
+		std::stringstream stream;
+		Layout<std::vector<uint32_t>>::Write(stream, many);
+		auto const [read] = Layout<std::vector<uint32_t>>::Read(stream);
+		expect(read == many, "Values read in parts");
+	}
+
+	void corrupt_offsets()
+	{
+		using serializer_helper::eFieldOffsets;
+		using Message = Layout<std::string, std::vector<int>, std::string>;
+
+		Serializer io(SerializerGrowth{});
+		Message::WriteWithOffsets(io, std::string{ "first" }, std::vector<int>{ 1, 2, 3 }, std::string{ "last" });
+		std::vector<std::byte> const bytes{ io.queued().begin(), io.queued().end() };
+
+		expect(Message::View{ bytes, eFieldOffsets::table }.get<2>() == "last", "Offset table");
+
+		// Table entries in front of the objects
+		auto const fails = [&bytes](size_t entry, uint64_t offset)
+		{
+			std::vector<std::byte> corrupt = bytes;
+			std::memcpy(corrupt.data() + entry * sizeof(uint64_t), &offset, sizeof(offset));
+			return fails_to_read([&] { Message::View{ corrupt, eFieldOffsets::table }; });
+		};
+
+		expect(fails(1, 1000) && fails(2, 2) && fails(3, bytes.size()) && fails(1, uint64_t(-8)), "Corrupt offset tables");
+
+		// A count of values whose byte size wraps around
+		std::vector<std::byte> view(16);
+		uint64_t const count = (uint64_t{ 1 } << 62) + 1;
+		std::memcpy(view.data(), &count, sizeof(count));
+		expect(fails_to_read([&] { Layout<std::span<uint32_t const>>::View{ view }.get<0>(); }), "Corrupt count of a view");
+
+		// Skipped distances that wrap around
+		std::vector<std::byte> skipped(40);
+		std::memcpy(skipped.data(), &count, sizeof(count));
+		expect(fails_to_read([&] { Layout<std::vector<uint32_t>, uint32_t>::View{ skipped }.get<1>(); }), "Corrupt count of a skipped array");
+
+		uint64_t const header[]{ uint64_t{ 1 } << 61, 8 };
+		std::memcpy(skipped.data(), header, sizeof(header));
+		expect(fails_to_read([&] { Layout<serializer_helper::Indexed<std::vector<uint32_t>>, uint32_t>::View{ skipped }.get<1>(); }), "Corrupt count of a skipped index");
+	}
+
+	// Destructors flush what was written and swallow the errors, reading leaves the stream alone
+	void destructors()
+	{
+		using serializer_helper::LzCodec;
+		using serializer_helper::CompressedStream;
+		using serializer_helper::ChecksumStream;
+		using serializer_helper::ScatterReader;
+
+		// A flush that overflows the stream
+		{
+			Serializer<16> small;
+			CompressedStream<LzCodec, Serializer<16>> compressed{ small };
+			Layout<std::string>::Write(compressed, std::string(100, 'x'));
+			expect(fails_to_read([&] { compressed.flush(); }), "Explicit flush reports errors");
+		}
+		{
+			Serializer<16> small;
+			CompressedStream<LzCodec, Serializer<16>> compressed{ small };
+			Layout<std::string>::Write(compressed, std::string(100, 'x'));
+		}
+
+		Serializer io(SerializerGrowth{});
+		{
+			CompressedStream<LzCodec, Serializer<>> compressed{ io };
+			Layout<int, int>::Write(compressed, 1, 2);
+		}
+		{
+			CompressedStream<LzCodec, Serializer<>> compressed{ io };
+			auto const [first] = Layout<int>::Read(compressed);
+			expect(first == 1, "Compressed block read");
+		}
+		expect(io.size() == 0, "Read ahead bytes not written back");
+
+		{
+			Serializer<16> small;
+			ChecksumStream checked{ small };
+			Layout<std::string>::Write(checked, std::string(100, 'x'));
+			expect(fails_to_read([&] { checked.flush(); }), "Explicit checksum flush reports errors");
+		}
+		{
+			Serializer<16> small;
+			ChecksumStream checked{ small };
+			Layout<std::string>::Write(checked, std::string(100, 'x'));
+		}
+
+		// Over a read-only stream
+		TempFile const file;
+		{
+			std::ofstream os{ file.path, std::ios::binary };
+			ChecksumStream checked{ os };
+			Layout<std::string>::Write(checked, std::string{ "checked" });
+		}
+		std::FILE* const is = std::fopen(file.path.string().c_str(), "rb");
+		expect(is != nullptr, "Checksum file opened");
+		{
+			ScatterReader<> reader{ fileno(is) };
+			ChecksumStream checked{ reader };
+			auto const [read] = Layout<std::string>::Read(checked);
+			expect(read == "checked", "Checksum stream over a read-only stream");
+		}
+		std::fclose(is);
+	}
+
+	// Layers over a GatherWriter reuse their buffers before it is flushed
+	void gather_writes()
+	{
+		using serializer_helper::LzCodec;
+		using serializer_helper::CompressedStream;
+		using serializer_helper::ChecksumStream;
+		using serializer_helper::GatherWriter;
+		using serializer_helper::ScatterReader;
+		using serializer_helper::BigEndianFormat;
+
+		using Values = BasicLayout<BigEndianFormat, std::vector<uint32_t>, std::vector<uint32_t>>;
+		std::vector<uint32_t> first(3000), second(5000);
+		for (uint32_t i = 0; i < first.size(); ++i)
+			first[i] = i * 2654435761u;
+		for (uint32_t i = 0; i < second.size(); ++i)
+			second[i] = i;
+
+		TempFile const file;
+		std::FILE* const out = std::fopen(file.path.string().c_str(), "wb");
+		expect(out != nullptr, "Gather file created");
+		{
+			GatherWriter<> writer{ fileno(out) };
+
+			// Swapped through a staging block
+			Values::Write(writer, first, second);
+
+			// Framed and compressed in reused blocks
+			{
+				ChecksumStream checked{ writer };
+				Values::Write(checked, first, second);
+			}
+			{
+				ChecksumStream<GatherWriter<>> checked{ writer };
+				CompressedStream<LzCodec, ChecksumStream<GatherWriter<>>> compressed{ checked };
+				Values::Write(compressed, first, second);
+			}
+
+			// Referenced in place
+			Layout<std::vector<uint32_t>>::Write(writer, first);
+		}
+		std::fclose(out);
+
+		std::FILE* const in = std::fopen(file.path.string().c_str(), "rb");
+		expect(in != nullptr, "Gather file opened");
+		{
+			ScatterReader<> reader{ fileno(in) };
+
+			auto const [a, b] = Values::Read(reader);
+			expect(a == first && b == second, "Gathered swapped arrays");
+			{
+				ChecksumStream checked{ reader };
+				auto const [c, d] = Values::Read(checked);
+				expect(c == first && d == second, "Gathered checksum blocks");
+			}
+			{
+				ChecksumStream<ScatterReader<>> checked{ reader };
+				CompressedStream<LzCodec, ChecksumStream<ScatterReader<>>> compressed{ checked };
+				auto const [e, f] = Values::Read(compressed);
+				expect(e == first && f == second, "Gathered compressed blocks");
+			}
+			auto const [g] = Layout<std::vector<uint32_t>>::Read(reader);
+			expect(g == first, "Gathered referenced array");
+		}
+		std::fclose(in);
+	}
+
+	// A Parallel container with a corrupt header: count, elements per chunk and the sizes of the chunks
+	void corrupt_chunks()
+	{
+		using Chunked = Layout<serializer_helper::Parallel<std::vector<uint32_t>, 4>>;
+
+		auto const corrupt = [](uint64_t count, uint64_t elements, std::vector<uint64_t> const& sizes)
+		{
+			Serializer io(SerializerGrowth{});
+			io.write(count);
+			io.write(elements);
+			Layout<std::vector<uint64_t>>::Write(io, sizes);
+			for (uint32_t i = 0; i < 8; ++i)
+				io.write(i);
+			return std::vector<std::byte>{ io.queued().begin(), io.queued().end() };
+		};
+
+		// Read from a buffer, from an iostream and skipped by a view
+		auto const fails = [](std::vector<std::byte> const& bytes)
+		{
+			bool const buffer = fails_to_read([&]
+			{
+				Serializer io(SerializerGrowth{});
+				io.write(std::span{ bytes });
+				Chunked::Read(io);
+			});
+			bool const stream = fails_to_read([&]
+			{
+				std::stringstream io{ std::string{ reinterpret_cast<char const*>(bytes.data()), bytes.size() } };
+				Chunked::Read(io);
+			});
+			bool const skipped = fails_to_read([&]
+			{
+				Layout<serializer_helper::Parallel<std::vector<uint32_t>, 4>, uint32_t>::View{ bytes }.get<1>();
+			});
+			return buffer && stream && skipped;
+		};
+
+		{
+			Serializer io(SerializerGrowth{});
+			Chunked::Write(io, serializer_helper::Parallel<std::vector<uint32_t>, 4>{ { 1, 2, 3, 4, 5, 6, 7, 8 } });
+			auto const [read] = Chunked::Read(io);
+			expect(read == std::vector<uint32_t>{ 1, 2, 3, 4, 5, 6, 7, 8 }, "Chunked round trip");
+		}
+
+		expect(fails(corrupt(2, 1, { uint64_t(-8), 16 })), "Chunk sizes wrapping around");
+		expect(fails(corrupt(2, 1, { uint64_t{ 1 } << 40, 16 })), "Chunk sizes past the end");
+		expect(fails(corrupt(uint64_t{ 1 } << 60, uint64_t{ 1 } << 60, { 32 })), "Corrupt count of a chunked container");
+
+		// Tables of 2^33 sizes in 24 bytes, one not matching the count
+		auto const table = [](uint64_t count, uint64_t elements, uint64_t chunks)
+		{
+			uint64_t const header[]{ count, elements, chunks };
+			std::vector<std::byte> bytes(sizeof(header));
+			std::memcpy(bytes.data(), header, sizeof(header));
+			return bytes;
+		};
+		expect(fails(table(8, 4, uint64_t{ 1 } << 33)), "Chunk table longer than the chunks");
+		expect(fails(table(uint64_t{ 1 } << 35, 4, uint64_t{ 1 } << 33)), "Chunk table past the end");
+	}
+
+	// Packed integers through the kernels enabled for this build, and with corrupt counts and sizes
+	void packed()
+	{
+		using serializer_helper::Packed;
+		using serializer_helper::ePacking;
+		using Ids = Layout<Packed<std::vector<uint32_t>>, Packed<std::vector<int16_t>, ePacking::frame>>;
+
+		std::vector<uint32_t> ids(1000);
+		std::vector<int16_t> samples(1000);
+		for (uint32_t i = 0; i < ids.size(); ++i)
+		{
+			ids[i] = i * 37 + i % 5;
+			samples[i] = int16_t(int(i % 300) - 150);
+		}
+
+		Serializer io(SerializerGrowth{});
+		Ids::Write(io, Packed<std::vector<uint32_t>>{ ids }, Packed<std::vector<int16_t>, ePacking::frame>{ samples });
+		std::string const bytes{ reinterpret_cast<char const*>(io.queued().data()), io.queued().size() };
+		{
+			auto const [read, read2] = Ids::Read(io);
+			expect(read == ids && read2 == samples, "Packed from a buffer");
+		}
+		{
+			std::stringstream is{ bytes };
+			auto const [read, read2] = Ids::Read(is);
+			expect(read == ids && read2 == samples, "Packed from a stream");
+		}
+
+		// Count and size of the encoded bytes in front of a few of them
+		auto const fails = [](uint64_t count, uint64_t size)
+		{
+			Serializer corrupt(SerializerGrowth{});
+			corrupt.write(count);
+			corrupt.write(size);
+			for (uint32_t i = 0; i < 16; ++i)
+				corrupt.write(i);
+
+			std::stringstream is{ std::string{ reinterpret_cast<char const*>(corrupt.queued().data()), corrupt.queued().size() } };
+			return fails_to_read([&] { Layout<Packed<std::vector<uint32_t>>>::Read(corrupt); })
+				&& fails_to_read([&] { Layout<Packed<std::vector<uint32_t>>>::Read(is); });
+		};
+
+		expect(fails(uint64_t(-1) / 2, uint64_t(-1) / 2), "Packed count overflowing its bound");
+		expect(fails(uint64_t{ 1 } << 38, uint64_t{ 1 } << 40), "Packed size past the end");
+	}
+
+	// Bytes of a file
+	std::string file_bytes(std::filesystem::path const& path)
+	{
+		std::ifstream is{ path, std::ios::binary };
+		return { std::istreambuf_iterator<char>{ is }, {} };
+	}
+
+	// Flushes of partial blocks, carried into the next buffer and padded in direct mode
+	void async_file(serializer_helper::eWriteMode mode)
+	{
+		using serializer_helper::AsyncFileWriter;
+		using Entry = Layout<std::string, std::vector<uint32_t>>;
+
+		TempFile const file;
+		Serializer expected(SerializerGrowth{});
+		{
+			std::optional<AsyncFileWriter<4 * 4096>> writer;
+			try
+			{
+				writer.emplace(file.path, mode);
+			}
+			catch (std::system_error const&)
+			{
+				// File systems like tmpfs have no direct I/O
+				expect(mode == serializer_helper::eWriteMode::direct, "Async file opened");
+				std::puts("Skipped direct async writes, not supported in the temporary directory");
+				return;
+			}
+
+			for (uint32_t round = 0; round < 8; ++round)
+			{
+				// Entries from a few bytes up to several buffers
+				for (uint32_t i = 0; i <= round; ++i)
+				{
+					std::vector<uint32_t> values(size_t(round) * round * 700 + i * 13);
+					for (uint32_t j = 0; j < values.size(); ++j)
+						values[j] = round ^ i ^ j;
+
+					std::string const name(i * 7 + 1, char('a' + round));
+					Entry::Write(*writer, name, values);
+					Entry::Write(expected, name, values);
+				}
+
+				writer->flush();
+				std::string const bytes = file_bytes(file.path);
+				expect(writer->size() == expected.size(), "Async bytes written");
+				expect(bytes.size() >= expected.size() && std::memcmp(bytes.data(), expected.queued().data(), expected.size()) == 0, "Async file flushed");
+			}
+			writer->sync();
+
+			// A partial block left to the destructor
+			Layout<std::string>::Write(*writer, std::string{ "end" });
+			Layout<std::string>::Write(expected, std::string{ "end" });
+		}
+
+		std::string const bytes = file_bytes(file.path);
+		expect(bytes.size() == expected.size() && std::memcmp(bytes.data(), expected.queued().data(), bytes.size()) == 0, "Async file closed at its size");
+	}
+
+	// Frames of size bytes holding value, as many times as fit
+	template <typename Queue>
+	bool push(Queue& queue, uint32_t value, size_t size)
+	{
+		auto slot = queue.try_reserve(size);
+		if (!slot)
+			return false;
+
+		for (size_t i = 0; i < size / sizeof(value); ++i)
+			slot->write(value);
+		queue.publish(*slot);
+		return true;
+	}
+
+	template <typename Queue>
+	std::optional<std::vector<uint32_t>> pop(Queue& queue)
+	{
+		auto frame = queue.try_front();
+		if (!frame)
+			return std::nullopt;
+
+		std::vector<uint32_t> values(frame->size() / sizeof(uint32_t));
+		for (uint32_t& value : values)
+			value = frame->template read<uint32_t>();
+		queue.pop();
+		return values;
+	}
+
+	template <eProducers PRODUCERS>
+	void queue_wrap_around()
+	{
+		{
+			SerializerQueue<64, PRODUCERS> queue;
+
+			// Three frames of 16 bytes leave 16 at the end
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				expect(push(queue, i, 8), "Queue push");
+				expect(pop(queue) == std::vector<uint32_t>(2, i), "Queue pop");
+			}
+
+			// Frames of up to half the queue wrap around an empty queue at once
+			expect(push(queue, 7, 24), "Queue frame wrapping around");
+			expect(pop(queue) == std::vector<uint32_t>(6, 7) && !pop(queue), "Queue wrapped frame");
+
+			// Larger ones once the consumer passed the padding in front of them
+			expect(!push(queue, 8, 40) && !pop(queue) && push(queue, 8, 40), "Queue large frame wrapping around");
+			expect(!push(queue, 9, 16), "Queue full");
+			expect(pop(queue) == std::vector<uint32_t>(10, 8) && !pop(queue), "Queue large wrapped frame");
+
+			// The full check left padding up to the end
+			expect(push(queue, 9, 56), "Queue frame as large as the queue");
+			expect(pop(queue) == std::vector<uint32_t>(14, 9) && !pop(queue), "Queue frame as large as the queue read");
+		}
+
+		// Against a model, at every offset of the buffer
+		SerializerQueue<256, PRODUCERS> queue;
+		std::deque<std::vector<uint32_t>> model;
+		uint32_t value{};
+		for (size_t step = 0; step < 10'000; ++step)
+		{
+			size_t const size = (step * 7919 % 61) / 4 * 4;
+			if (step % 3 != 2 && push(queue, value, size))
+				model.emplace_back(size / sizeof(value), value++);
+			else if (auto const values = pop(queue))
+			{
+				expect(!model.empty() && *values == model.front(), "Queue against a model");
+				model.pop_front();
+			}
+			else
+				expect(model.empty(), "Queue empty like the model");
+		}
+	}
+
+	// Producers push count frames of varying sizes with their id and a sequence number, in order per producer
+	template <eProducers PRODUCERS>
+	void queue_stress(uint32_t producers)
+	{
+		constexpr uint32_t count = 100'000;
+		SerializerQueue<1024, PRODUCERS> queue;
+
+		std::vector<std::thread> threads;
+		for (uint32_t id = 0; id < producers; ++id)
+			threads.emplace_back([&queue, id]
+			{
+				for (uint32_t i = 0; i < count; )
+				{
+					// Length, id, sequence number, then filler up to the length
+					size_t const size = 12 + (i * 4 + id) % 100 / 4 * 4;
+					auto slot = queue.try_reserve(size);
+					if (!slot)
+					{
+						std::this_thread::yield();
+						continue;
+					}
+					slot->write(uint32_t(size));
+					slot->write(id);
+					slot->write(i);
+					for (size_t filler = 12; filler < size; filler += 4)
+						slot->write(i ^ uint32_t(filler));
+					queue.publish(*slot);
+					++i;
+				}
+			});
+
+		std::vector<uint32_t> next(producers);
+		for (uint64_t received = 0; received < uint64_t(count) * producers; )
+		{
+			auto frame = queue.try_front();
+			if (!frame)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			uint32_t const size = frame->template read<uint32_t>();
+			uint32_t const id = frame->template read<uint32_t>();
+			uint32_t const i = frame->template read<uint32_t>();
+			bool intact = size == frame->size() + 12 && id < producers && i == next[id]++;
+			for (size_t filler = 12; intact && filler < size; filler += 4)
+				intact = frame->template read<uint32_t>() == (i ^ uint32_t(filler));
+
+			expect(intact, "Queue frames intact and in order per producer");
+			queue.pop();
+			++received;
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+		expect(!queue.try_front(), "Queue drained");
+	}
+
+}
+
+int main()
+{
+	mapped_file();
+
+	corrupt_counts();
+	corrupt_offsets();
+	corrupt_chunks();
+
+	packed();
+
+	async_file(serializer_helper::eWriteMode::cached);
+	async_file(serializer_helper::eWriteMode::direct);
+
+	destructors();
+	gather_writes();
+
+	queue_wrap_around<eProducers::single>();
+	queue_wrap_around<eProducers::multiple>();
+	queue_stress<eProducers::single>(1);
+	queue_stress<eProducers::multiple>(4);
+
+	std::puts("All tests passed");
+}
@@ -122,6 +122,32 @@ int main()
 		SetLayout::Read(file, num, names);
 	}
 
+
+	// Example of an aggregate, its fields are serialized without a hand-written layout
+
+	struct Measurement
+	{
+		std::string name;
+		std::vector<float> values;
+		long timestamp;
+	};
+
+	using MeasurementLayout = Layout<std::vector<Measurement>>;
+
+	{
+		std::vector<Measurement> measurements{ { "height", { 1.8f, 1.7f }, 1234 } };
+
+		std::ofstream file{ "measurements.bin", std::ios::out | std::ios::binary };
+		MeasurementLayout::Write(file, measurements);
+	}
+
+	{
+		std::vector<Measurement> measurements{};
+
+		std::ifstream file{ "measurements.bin", std::ios::in | std::ios::binary };
+		MeasurementLayout::Read(file, measurements);
+	}
+
 	return 0;
 
 }